@@ -13,7 +13,7 @@ void main()
         
 layout(location = 0) out vec4 color;
 
-uniform vec4 u_Color;
+#include "ColorBlock.glsl"
         
 void main()
 {
@@ -0,0 +1,29 @@
+#shader vertex
+#version 330 core
+
+layout(location = 0) in vec4 position;
+//per instance (divisor 1), QuadInstance in Application.cpp
+layout(location = 1) in vec2 a_Offset;
+layout(location = 2) in float a_Scale;
+layout(location = 3) in vec4 a_Color;
+
+out vec4 v_Color;
+
+void main()
+{
+    v_Color = a_Color;
+    gl_Position = vec4(position.xy * a_Scale + a_Offset, position.zw);
+}
+
+#shader fragment
+#version 330 core
+
+layout(location = 0) out vec4 color;
+
+//the instance's color takes the place of Basic.shader's u_Color
+in vec4 v_Color;
+
+void main()
+{
+    color = v_Color;
+}
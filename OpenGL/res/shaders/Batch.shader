@@ -0,0 +1,53 @@
+#shader vertex
+#version 330 core
+
+//QuadVertex in BatchRenderer.h, checked with ValidateVertexLayout when it's created
+layout(location = 0) in vec2 a_Position;
+layout(location = 1) in vec2 a_TexCoord;
+layout(location = 2) in vec4 a_Color;
+layout(location = 3) in float a_TexIndex;
+
+out vec2 v_TexCoord;
+out vec4 v_Color;
+flat out int v_TexIndex;
+
+void main()
+{
+    v_TexCoord = a_TexCoord;
+    v_Color = a_Color;
+    v_TexIndex = int(a_TexIndex);
+    gl_Position = vec4(a_Position, 0.0, 1.0);
+}
+
+#shader fragment
+#version 330 core
+
+layout(location = 0) out vec4 color;
+
+in vec2 v_TexCoord;
+in vec4 v_Color;
+flat in int v_TexIndex;
+
+//texture slot i is bound to unit i, slot 0 is a 1x1 white texture
+uniform sampler2D u_Textures[8];
+
+vec4 SampleSlot(int slot, vec2 uv)
+{
+    //3.30 only allows constant indices into a sampler array
+    switch (slot)
+    {
+    case 1: return texture(u_Textures[1], uv);
+    case 2: return texture(u_Textures[2], uv);
+    case 3: return texture(u_Textures[3], uv);
+    case 4: return texture(u_Textures[4], uv);
+    case 5: return texture(u_Textures[5], uv);
+    case 6: return texture(u_Textures[6], uv);
+    case 7: return texture(u_Textures[7], uv);
+    default: return texture(u_Textures[0], uv);
+    }
+}
+
+void main()
+{
+    color = v_Color * SampleSlot(v_TexIndex, v_TexCoord);
+}
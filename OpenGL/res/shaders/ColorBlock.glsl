@@ -0,0 +1,5 @@
+//std140 so the layout is fixed, ColorBlock in Application.cpp mirrors it
+layout(std140) uniform ColorBlock
+{
+    vec4 u_Color;
+};
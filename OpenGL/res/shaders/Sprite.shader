@@ -0,0 +1,28 @@
+#shader vertex
+#version 330 core
+
+//the quad from main(), moved and sized per draw by RunCommandBenchmark's SetUniform4f commands
+layout(location = 0) in vec4 position;
+
+uniform vec4 u_Transform; //xy offset, z scale
+uniform vec4 u_Color;
+
+out vec4 v_Color;
+
+void main()
+{
+    v_Color = u_Color;
+    gl_Position = vec4(position.xy * u_Transform.z + u_Transform.xy, position.zw);
+}
+
+#shader fragment
+#version 330 core
+
+layout(location = 0) out vec4 color;
+
+in vec4 v_Color;
+
+void main()
+{
+    color = v_Color;
+}
@@ -3,163 +3,364 @@
 #include <GLFW/glfw3.h>
 #include <fstream>
 #include <string>
-#include <sstream>
-//__debugbreak() is MSVC compiler specific
-#define ASSERT(x) if (!(x)) __debugbreak(); 
-#define GLCall(x) GLClearError();\
-    x;\
-    ASSERT(GLLogCall(#x, __FILE__, __LINE__))
-
-static void GLClearError()
+#include <cstring>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <memory>
+#include <vector>
+#include "Benchmarks.h"
+#include "DebugSink.h"
+#include "GLStateCache.h"
+#include "Headless.h"
+#include "IndexBuffer.h"
+#include "InstanceBuffer.h"
+#include "ProgramCache.h"
+#include "Renderer.h"
+#include "ShaderArchive.h"
+#include "Shader.h"
+#include "ShaderCompiler.h"
+#include "ShaderHotReload.h"
+#include "ShaderPipeline.h"
+#include "ShaderReflection.h"
+#include "ShaderWarmup.h"
+#include "SoftwareRasterizer.h"
+#include "UniformBuffer.h"
+#include "UniformState.h"
+#include "VertexArray.h"
+#include "VertexBuffer.h"
+#include "VertexLayout.h"
+#ifdef EMBEDDED_SHADERS
+//made by ShaderPacker --header, see README
+#include "EmbeddedShaders.generated.h"
+#endif
+
+//Command line options
+//  --headless   render into an offscreen framebuffer, no window or display needed
+//  --software   render on the CPU with SoftwareRasterizer, no GL context at all
+//  --frames N   how many frames a headless/software run renders before printing its timings
+//  --quads N    software only: draw an NxN grid of quads instead of the single quad
+//  --threads N  software and --bench-commands only: worker count, 0 is one per core
+//  --dump FILE  write the last headless/software frame to a PPM file
+//  --no-program-cache  always compile and link, don't use ./res/cache
+//  --compile-threads N  shader compile workers when the driver can't compile in parallel itself
+//  --bench-parser [FILE]  time ParseShader() on FILE, or on generated files, and exit
+//  --bench-pipelines N  link N*N Basic.shader variant pairs, then build them as separable stages, and exit
+//  --bench-batch N  draw N quads a frame with BatchRenderer and with a draw per quad, and exit
+//  --bench-sort N  replay N random draws a frame through DrawBucket unsorted and sorted by key, and exit
+//  --bench-commands N  animate N objects a frame and draw them directly, through one CommandList and from --threads threads, and exit
+//  --no-hot-reload  don't rebuild shaders when their files change (windowed runs only, Linux)
+//  --shader-archive FILE  load shaders from a ShaderPacker archive instead of the loose files
+//  --no-warmup  draw with a program as soon as it's compiled, without a warm-up draw first
+//  --instances N  draw an NxN-ish grid of the quad with one instanced draw (BasicInstanced.shader)
+struct AppOptions
 {
-    //runs through all the errors to clear it
-    while (glGetError() != GL_NO_ERROR);
-}
+    bool Headless = false;
+    bool Software = false;
+    int Frames = 600;
+    int Quads = 1;
+    unsigned int Threads = 0;
+    std::string DumpPath;
+    bool ProgramCache = true;
+    unsigned int CompileThreads = 2;
+    bool BenchParser = false;
+    std::string BenchParserPath;
+    int BenchPipelines = 0;
+    int BenchBatch = 0;
+    int BenchSort = 0;
+    int BenchCommands = 0;
+    bool HotReload = true;
+    std::string ShaderArchivePath;
+    bool Warmup = true;
+    int Instances = 0;
+};
 
-static bool GLLogCall(const char* function, const char* file, int line)
+static AppOptions ParseOptions(int argc, char** argv)
 {
-    //as long as the error is not false
-    while (GLenum error =glGetError()) {
-        std::cout << "[OpenGL Error] (" << error << "): " 
-            <<function<<" "<<file<<":"<<line << std::endl;
-        return false;
+    AppOptions options;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--headless") == 0)
+            options.Headless = true;
+        else if (strcmp(argv[i], "--software") == 0)
+            options.Software = true;
+        else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc)
+            options.Frames = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--quads") == 0 && i + 1 < argc)
+            options.Quads = std::max(1, atoi(argv[++i]));
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+            options.Threads = (unsigned int)atoi(argv[++i]);
+        else if (strcmp(argv[i], "--dump") == 0 && i + 1 < argc)
+            options.DumpPath = argv[++i];
+        else if (strcmp(argv[i], "--no-program-cache") == 0)
+            options.ProgramCache = false;
+        else if (strcmp(argv[i], "--compile-threads") == 0 && i + 1 < argc)
+            options.CompileThreads = (unsigned int)atoi(argv[++i]);
+        else if (strcmp(argv[i], "--shader-archive") == 0 && i + 1 < argc)
+            options.ShaderArchivePath = argv[++i];
+        else if (strcmp(argv[i], "--no-hot-reload") == 0)
+            options.HotReload = false;
+        else if (strcmp(argv[i], "--no-warmup") == 0)
+            options.Warmup = false;
+        else if (strcmp(argv[i], "--instances") == 0 && i + 1 < argc)
+            options.Instances = std::max(0, atoi(argv[++i]));
+        else if (strcmp(argv[i], "--bench-pipelines") == 0 && i + 1 < argc)
+            options.BenchPipelines = std::max(1, atoi(argv[++i]));
+        else if (strcmp(argv[i], "--bench-batch") == 0 && i + 1 < argc)
+            options.BenchBatch = std::max(1, atoi(argv[++i]));
+        else if (strcmp(argv[i], "--bench-sort") == 0 && i + 1 < argc)
+            options.BenchSort = std::max(1, atoi(argv[++i]));
+        else if (strcmp(argv[i], "--bench-commands") == 0 && i + 1 < argc)
+            options.BenchCommands = std::max(1, atoi(argv[++i]));
+        else if (strcmp(argv[i], "--bench-parser") == 0)
+        {
+            options.BenchParser = true;
+            if (i + 1 < argc && strncmp(argv[i + 1], "--", 2) != 0)
+                options.BenchParserPath = argv[++i];
+        }
+        else
+            std::cout << "Unknown option: " << argv[i] << std::endl;
     }
-    return true;
+    return options;
 }
 
 
-//Code to create a shader
-//the strings are meant to be the actual source code
-//you can bring in shaders as a string or pull them from another file
-static unsigned int CompileShader(unsigned int type,const std::string& source)
+//Splits the [-0.5, 0.5] square that main() draws into quadsPerSide^2 quads,
+//with the same layout: 2 floats per vertex, 4 vertices and 6 indices (0,1,2,2,3,0) per quad.
+//A grid of 1 gives back exactly the positions/indices arrays in main().
+static void BuildQuadGrid(int quadsPerSide, std::vector<float>& positions, std::vector<unsigned int>& indices)
 {
-    unsigned int id = glCreateShader(type);
-    //c_str returns a pointer the string
-    //you can also do &source[0] to get the mem address of the first char
-    //source needs to exist at this point when you compile this code
-    //or it can point to random memory and cause an error
-    const char* src = source.c_str();
-    //takes a pointer to the pointer and a length to the string
-    //by putting nullptr, it assumes that the null terminator ends
-    //the string so you don't have to put the length
-    glShaderSource(id, 1, &src, nullptr);
-    glCompileShader(id);// doesn't return anything, but can be queried
-
-    int result;
-    glGetShaderiv(id, GL_COMPILE_STATUS, &result);
-    if (result == GL_FALSE)
+    float size = 1.0f / quadsPerSide;
+    for (int y = 0; y < quadsPerSide; y++)
     {
-        int length;
-        glGetShaderiv(id, GL_INFO_LOG_LENGTH, &length);
-        //some people use heap memory to get the message and delete it
-        //but this little hack lets you use stack memory to get the message
-        //alloca is a function that C gives you that allocate on the stack dynamically
-        char* message= (char*)alloca(length*sizeof(char));
-        glGetShaderInfoLog(id, length, &length, message);
-        //There are more than two types of shaders, but for this demo, it's enough
-        std::cout << "Failed to compile "<<(type==GL_VERTEX_SHADER?"vertex":"fragment") << " shader"<< std::endl;
-        std::cout << message << std::endl;
-        glDeleteShader(id);
-        return 0;
+        for (int x = 0; x < quadsPerSide; x++)
+        {
+            float x0 = -0.5f + x * size, y0 = -0.5f + y * size;
+            float quad[] = {
+                x0, y0,
+                x0 + size, y0,
+                x0 + size, y0 + size,
+                x0, y0 + size
+            };
+            unsigned int base = (unsigned int)(positions.size() / 2);
+            unsigned int quadIndices[] = { base, base + 1, base + 2, base + 2, base + 3, base };
+            positions.insert(positions.end(), quad, quad + 8);
+            indices.insert(indices.end(), quadIndices, quadIndices + 6);
+        }
     }
-    //TODO: Error handling
-    return id;
 }
-static unsigned int CreateShader(const std::string& vertexShader, const std::string& fragmentShader)
+
+//The render loop from main(), with every GL call swapped for its SoftwareRasterizer twin
+static int RunSoftwareRenderer(const AppOptions& options)
 {
-    //returns an unsigned int
-    //you can use GLuint but if you use something besides opengl, your code won't be as compatible
-    unsigned int program = glCreateProgram();
-    unsigned int vs = CompileShader(GL_VERTEX_SHADER, vertexShader);
-    unsigned int fs = CompileShader(GL_FRAGMENT_SHADER, fragmentShader);
-
-    //Now we attach the shaders to the program and link it
-    GLCall(glAttachShader(program, vs));
-    GLCall(glAttachShader(program, fs));
-    GLCall(glLinkProgram(program));
-    GLCall(glValidateProgram(program));
-
-    //After the shaders have been linked, we can delete the "intermediates"
-    //technically we should be called glDetachShader, to get rid of the source code
-    //but it can be useful for debuggin with the downside of taking up a trival amount
-    //of memory. A lot of game engines don't bother detaching.
-    //that topic will discussed later on
-    GLCall(glDeleteShader(vs));
-    GLCall(glDeleteShader(fs));
-
-    return program;
+    std::vector<float> positions;
+    std::vector<unsigned int> indices;
+    BuildQuadGrid(options.Quads, positions, indices);
+
+    SoftwareRasterizer rasterizer(640, 480, options.Threads);
+    rasterizer.BufferData(GL_ARRAY_BUFFER, positions.size() * sizeof(float), positions.data());
+    rasterizer.BufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data());
+    rasterizer.VertexAttribPointer(0, 2, GL_FLOAT, false, sizeof(float) * 2, 0);
+
+    std::cout << "[Software] " << indices.size() / 3 << " triangles on "
+        << rasterizer.GetThreadCount() << " threads" << std::endl;
+
+    float r = 0.0f;
+    float increment = 0.05f;
+    FrameTimer timer;
+    timer.BeginRun();
+    for (int frame = 0; frame < options.Frames; frame++)
+    {
+        rasterizer.Clear();
+        rasterizer.Uniform4f(r, 0.3f, 0.8f, 1.0f);
+        rasterizer.DrawElements(GL_TRIANGLES, (int)indices.size(), GL_UNSIGNED_INT, 0);
+
+        if (r > 1.0f)
+            increment = -0.05f;
+        else if (r < 0.0f)
+            increment = 0.05f;
+
+        r += increment;
+        timer.EndFrame();
+    }
+    timer.EndRun();
+    timer.Print();
+
+    if (!options.DumpPath.empty())
+    {
+        std::vector<unsigned char> pixels;
+        rasterizer.ReadPixels(pixels);
+        WriteImagePPM(options.DumpPath, rasterizer.GetWidth(), rasterizer.GetHeight(), pixels);
+    }
+    return 0;
 }
 
-struct ShaderProgramSource 
-{
-    std::string VertexSource;
-    std::string FragmentSource;
-};
 
-static ShaderProgramSource ParseShader(const std::string& filepath)
+//Hidden contexts that share objects with the main one, for ShaderCompiler's
+//worker threads. Only made when the driver can't compile in parallel by itself.
+struct CompileContexts
 {
-    std::ifstream stream(filepath);
-    enum class ShaderType
-    {
-        NONE=-1, VERTEX=0, FRAGMENT=1
-    };
-    std::string line;
-    std::stringstream ss[2];
-    ShaderType type=ShaderType::NONE;
+    std::vector<GLFWwindow*> Windows;
+    std::vector<std::unique_ptr<HeadlessContext>> Headless;
+    std::vector<SharedContext> Contexts;
 
-    while (getline(stream, line))
+    void Create(unsigned int count, GLFWwindow* window, const HeadlessContext* headless)
     {
-        if (line.find("#shader") != std::string::npos)
+        if (GLEW_KHR_parallel_shader_compile || GLEW_ARB_parallel_shader_compile)
+            return;
+        for (unsigned int i = 0; i < count; i++)
         {
-            if (line.find("vertex") != std::string::npos)
+            if (headless)
             {
-                type = ShaderType::VERTEX; //set mode to vertex
+                Headless.push_back(std::make_unique<HeadlessContext>());
+                HeadlessContext* context = Headless.back().get();
+                if (!context->Create(3, 3, headless))
+                    break;
+                Contexts.push_back({ [context] { context->MakeCurrent(); }, [context] { context->DoneCurrent(); } });
             }
-            else if (line.find("fragment") != std::string::npos)
+            else
             {
-                type = ShaderType::FRAGMENT; //set mode to fragment
+                glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+                GLFWwindow* shared = glfwCreateWindow(1, 1, "Compile", NULL, window);
+                glfwDefaultWindowHints();
+                if (!shared)
+                    break;
+                Windows.push_back(shared);
+                Contexts.push_back({ [shared] { glfwMakeContextCurrent(shared); }, [] { glfwMakeContextCurrent(NULL); } });
             }
-           
-        }
-        else
-        {
-            ss[(int)type] << line << '\n';
         }
     }
-    return { ss[0].str(),ss[1].str() };
-}
+
+    void Destroy()
+    {
+        for (GLFWwindow* shared : Windows)
+            glfwDestroyWindow(shared);
+        Windows.clear();
+        Headless.clear();
+        Contexts.clear();
+    }
+};
 
 
+//Mirrors ColorBlock.glsl. The static_asserts fail to compile if
+//the C++ layout ever stops matching std140.
+struct ColorBlock
+{
+    std140::vec4 Color;
 
+    using Layout = Std140Layout<std140::vec4>;
+};
+STD140_CHECK_MEMBER(ColorBlock, 0, Color);
+STD140_CHECK_SIZE(ColorBlock);
+//an array of elements bigger than a vec4 is still only aligned to 16
+static_assert(Std140Layout<float, std140::mat4[2]>::Offsets[1] == 16, "std140 puts a mat4[2] after a float at 16");
+static_assert(Std140Layout<float, std140::mat4[2]>::Size == 144, "a float and a mat4[2] make a 144 byte std140 block");
 
+//the uniform buffer binding point ColorBlock is read from
+static const unsigned int s_ColorBlockBinding = 0;
 
-int main()
+//the quad's vertices: 2 floats of position at location 0, like Basic.shader reads them
+using QuadLayout = VertexLayout<Float2>;
+static_assert(QuadLayout::Stride == 2 * sizeof(float), "positions[] holds 2 floats per vertex");
+
+//what BasicInstanced.shader reads once per instance, from location 1 on
+struct QuadInstance
 {
-    GLFWwindow* window;
+    float Offset[2];
+    float Scale;
+    uint8_t Color[4];
 
-    /* Initialize the library */
-    if (!glfwInit())
-        return -1;
+    using Layout = VertexLayout<Float2, Float1, UByte4Norm>;
+};
+static_assert(sizeof(QuadInstance) == QuadInstance::Layout::Stride, "QuadInstance has padding its layout doesn't know about");
 
- 
 
+int main(int argc, char** argv)
+{
+    AppOptions options = ParseOptions(argc, argv);
+    if (options.BenchParser)
+        return RunParserBenchmark(options.BenchParserPath);
+    if (options.Software)
+        return RunSoftwareRenderer(options);
 
-    /* Create a windowed mode window and its OpenGL context */
-    window = glfwCreateWindow(640, 480, "Hello World", NULL, NULL);
-    if (!window)
+    //GL errors and debug messages get printed from a background thread
+    DebugSink::Get().Start();
+
+    GLFWwindow* window = nullptr;
+    HeadlessContext headless;
+
+    if (options.Headless)
     {
-        glfwTerminate();
-        return -1;
+        if (!headless.Create())
+            return -1;
+        //core profile contexts need this or glew leaves the VAO functions null
+        glewExperimental = GL_TRUE;
     }
+    else
+    {
+        /* Initialize the library */
+        if (!glfwInit())
+            return -1;
+
+#if GL_ERROR_CHECK == GL_ERROR_CHECK_DEBUG_OUTPUT
+        //some drivers only send debug messages to debug contexts
+        glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, GLFW_TRUE);
+#endif
+        /* Create a windowed mode window and its OpenGL context */
+        window = glfwCreateWindow(640, 480, "Hello World", NULL, NULL);
+        if (!window)
+        {
+            glfwTerminate();
+            return -1;
+        }
 
-    /* Make the window's context current */
-    glfwMakeContextCurrent(window);
-    glfwSwapInterval(1);
+        /* Make the window's context current */
+        glfwMakeContextCurrent(window);
+        glfwSwapInterval(1);
+    }
 
-    if (glewInit() != GLEW_OK)
+    //glew built without EGL support still loads every GL function under EGL,
+    //it only complains that there is no GLX display to query
+    GLenum glewStatus = glewInit();
+    if (glewStatus != GLEW_OK && !(options.Headless && glewStatus == GLEW_ERROR_NO_GLX_DISPLAY))
         std::cout << "ERROR" << std::endl;
 
     std::cout << glGetString(GL_VERSION) << std::endl;
+    GLEnableDebugOutput();
+    if (options.ProgramCache)
+        ProgramBinaryCache::Get().Open("./res/cache");
+
+    OffscreenTarget offscreen;
+    if (options.Headless)
+    {
+        if (!offscreen.Create(640, 480))
+            return -1;
+        offscreen.Bind();
+    }
+    if (options.BenchPipelines)
+    {
+        int result = RunPipelineBenchmark(options.BenchPipelines);
+        DebugSink::Get().Stop();
+        return result;
+    }
+    if (options.BenchBatch)
+    {
+        int result = RunBatchBenchmark(options.BenchBatch);
+        DebugSink::Get().Stop();
+        return result;
+    }
+    if (options.BenchSort)
+    {
+        int result = RunSortBenchmark(options.BenchSort);
+        DebugSink::Get().Stop();
+        return result;
+    }
+    if (options.BenchCommands)
+    {
+        int result = RunCommandBenchmark(options.BenchCommands, options.Threads);
+        DebugSink::Get().Stop();
+        return result;
+    }
 
 
 
@@ -174,10 +375,9 @@ int main()
     //we use glGenBuffers to define a vertex buffer
     //the first parameter is how many buffers you would like
     //the second parameter is a pointer to an unsigned int
-    unsigned int buffer;
-    unsigned int vao;
-    GLCall(glGenVertexArrays(1, &vao));
-    GLCall(glGenBuffers(1, &buffer));
+    //VertexArray/VertexBuffer/IndexBuffer make those calls for us and own the
+    //names, so they're deleted again when they go away
+    VertexArray va;
     //the variable buffer acts as the id to the generated buffer
     //opengl acts as a state machine. Everything you generate in opengl gets
     //assigned a unique identifier. This will be for the objects.
@@ -194,8 +394,7 @@ int main()
 
     //the first parameter specifies we are using an array
     //the second parameter is the id we made called buffer
-    GLCall(glBindVertexArray(vao));
-    GLCall(glBindBuffer(GL_ARRAY_BUFFER, buffer));
+    va.Bind();
 
     //While it is obvious to use that there are 2 floats per vertex, openGL doesn't know that
     //But how does OpenGL know that the 6 points make 3 vertices of two points versus 2 vertices of 3 points
@@ -228,10 +427,8 @@ int main()
 
     //use GL_ELEMENT_ARRAY_BUFFER instead of GL_ARRAY_BUFFER for indices
     //index buffers have to be made up of unsigned ints
-    unsigned int ibo; //index buffer object
-    GLCall(glGenBuffers(1, &ibo));
-    GLCall(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo));
-    GLCall(glBufferData(GL_ELEMENT_ARRAY_BUFFER, 6 * sizeof(unsigned int), indices, GL_STATIC_DRAW));
+    IndexBuffer ib(indices, 6); //index buffer object
+    va.SetIndexBuffer(ib);
 
 
 
@@ -248,20 +445,20 @@ int main()
     // Fourth paramter is the usage enum
     //static and dynamic are the ones we usually use, but there's also stream
     //These are just hints to tell the GPU on how it will be implemented
-    GLCall(glBufferData(GL_ARRAY_BUFFER, 4*2*sizeof(float), positions,GL_STATIC_DRAW));
+    VertexBuffer vb(positions, 4 * 2 * sizeof(float), GL_STATIC_DRAW);
 
 
 
 
     //To make the VertexAttribPointer work, you need to use glEnableVertextAttribArray() first
     //this enables a vertex attribute. With index of 0, we are enabling the first attribute
-    GLCall(glEnableVertexAttribArray(0));
     //index 0 since it's the first attribute, count 2 floats, type of data, false for normalize
     //stride is the number of bytes between vertices [NOT ATTRIBUTES] 8bytes for sizeof(float) *2,
     //pointer is for the offset for the attribute, 0. 
     // If you another attribute for -0.5f, -0.5f, we would need to offset by 8bytes to reach it
     // but there is only one attribute which takes a 0byte offset to select
-    GLCall(glVertexAttribPointer(0,2,GL_FLOAT, GL_FALSE, sizeof(float)*2, 0 ));
+    //QuadLayout works all of that out at compile time, another attribute is just another type in the list
+    va.AddBuffer(vb, QuadLayout());
 
 
 
@@ -311,35 +508,165 @@ int main()
 
 
 
-    ShaderProgramSource source = ParseShader("./res/shaders/Basic.shader");
+#ifdef EMBEDDED_SHADERS
+    //compiled into the executable and split into stages by the compiler,
+    //no file is opened and nothing is parsed
+    constexpr EmbeddedShaderSource basicShader = FindEmbeddedShader("./res/shaders/Basic.shader");
+    static_assert(!basicShader.VertexSource.empty() && !basicShader.FragmentSource.empty(),
+        "Basic.shader isn't in EmbeddedShaders.generated.h, rerun ShaderPacker --header");
+    std::string_view vertexSource = basicShader.VertexSource, fragmentSource = basicShader.FragmentSource;
+    bool borrowSources = true;
+    options.HotReload = false;
+#else
+    //with an archive the sources are views into one mapped file, already
+    //split and #include expanded by ShaderPacker, nothing to parse or copy
+    ShaderArchive archive;
+    std::string_view vertexSource, fragmentSource;
+    bool borrowSources = !options.ShaderArchivePath.empty() && archive.Open(options.ShaderArchivePath)
+        && archive.Find("./res/shaders/Basic.shader", vertexSource, fragmentSource);
+    ShaderProgramSource source;
+    if (!borrowSources)
+    {
+        source = ParseShader("./res/shaders/Basic.shader");
+        vertexSource = source.VertexSource;
+        fragmentSource = source.FragmentSource;
+    }
+#endif
     //std::cout << "Vertex\n";
     //std::cout << source.VertexSource << std::endl;
     //std::cout << "Fragment\n";
     //std::cout << source.FragmentSource << std::endl;
 
+    //Shaders are compiled in the background, every program gets submitted up front
+    //and the render loop picks each one up when it's done instead of waiting on it
+    CompileContexts compileContexts;
+    compileContexts.Create(options.CompileThreads, window, options.Headless ? &headless : nullptr);
+    std::unique_ptr<ShaderCompiler> compiler = std::make_unique<ShaderCompiler>(compileContexts.Contexts);
+    //embedded sources and the archive's mapping outlive the compiler, so it can keep views into them
+    ShaderCompiler::Handle shaderJob = compiler->Submit(vertexSource, fragmentSource, borrowSources);
+    //a new program's first draw is where many drivers really compile it, so it
+    //gets a throwaway draw into a 1x1 target first, with the VAO it'll be drawn with
+    ShaderWarmup warmup;
+    options.Warmup = options.Warmup && warmup.Create();
+    const double warmupBudgetMs = 4.0; //per frame, a long list of programs spreads over several
+
+    //--instances draws the quad that many times with one glDrawElementsInstanced.
+    //Offset, scale and color come from instanceBuffer, which the VAO reads
+    //once per instance (divisor 1) next to the per vertex positions
+    unsigned int instancedShader = 0;
+    InstanceBuffer instanceBuffer;
+    if (options.Instances)
+    {
+        ShaderProgramSource instancedSource = ParseShader("./res/shaders/BasicInstanced.shader");
+        instancedShader = CreateShader(instancedSource.VertexSource, instancedSource.FragmentSource);
+        if (IsLinked(instancedShader))
+        {
+            instanceBuffer = InstanceBuffer(options.Instances * sizeof(QuadInstance));
+            va.AddBuffer(instanceBuffer.GetBuffer(), QuadInstance::Layout(), 1, VertexArray::BindingFromLocation, 1);
+            ValidateVertexLayout({ { QuadLayout(), 0 }, { QuadInstance::Layout(), 1 } }, instancedShader, "BasicInstanced.shader");
+            if (options.Warmup)
+            {
+                warmup.Add(instancedShader, "BasicInstanced.shader", { va.GetRendererID() });
+                warmup.Run();
+            }
+        }
+        else
+        {
+            //the single quad is drawn instead
+            std::cout << "BasicInstanced.shader failed to build, --instances is ignored" << std::endl;
+            if (instancedShader)
+            {
+                GLCall(glDeleteProgram(instancedShader));
+            }
+            instancedShader = 0;
+        }
+    }
+    //headless runs are benchmarks, only the frames with the draw should be timed
+    if (options.Headless)
+    {
+        compiler->Wait(shaderJob);
+        if (options.Warmup)
+        {
+            warmup.Add(compiler->GetProgram(shaderJob), "Basic.shader", { va.GetRendererID() });
+            warmup.Run();
+        }
+    }
 
-    unsigned int shader = CreateShader(source.VertexSource,source.FragmentSource);
-    GLCall(glUseProgram(shader));
-
-    //since we are using vec4, we need 4 floats, thus we use glUniform4f
-    //once a shader gets created, every shader gets an id so that we can reference it
-    //the way we can look up the id, typically, is by its name.
-    //glUniform4F's first parameter is the id for the uniform in the shader, which we
-    //can get wtih glGetUniformLocation passing shader and the name of the uniform as arguments
+    unsigned int shader = 0;
+    //every draw's ColorBlock goes into one buffer, uploaded once per frame
+    UniformBuffer colorBuffer;
+    colorBuffer.Create(64 * 1024);
+    //u_Color lives in a uniform block now instead of being set with glUniform4f.
+    //The block gets pointed at a binding, and each draw binds a range of
+    //colorBuffer there. CreateShader reflected the block when it linked,
+    //by a name hashed at compile time. Done again for every hot reloaded program
+    auto useShader = [&](unsigned int program)
+    {
+        shader = program;
+        GLStateCache::Get().UseProgram(shader);
+        constexpr uint64_t colorBlockName = HashName("ColorBlock");
+        UniformBlockHandle colorBlock = GetProgramReflection(shader)->GetUniformBlock(colorBlockName);
+        //not an ASSERT, a hot reloaded edit can get this wrong and shouldn't take the app down
+        if (!colorBlock.IsValid() || colorBlock.DataSize != (int)sizeof(ColorBlock))
+        {
+            std::cout << "Basic.shader's ColorBlock doesn't match the ColorBlock struct" << std::endl;
+            return;
+        }
+        GLCall(glUniformBlockBinding(shader, colorBlock.Index, s_ColorBlockBinding));
+        //an edited shader reading an input the quad doesn't have draws garbage, say so
+        ValidateVertexLayout(QuadLayout(), 0, shader, "Basic.shader");
+    };
 
-    GLCall(int location = glGetUniformLocation(shader, "u_Color"));
-    ASSERT(location != -1);
-    GLCall(glUniform4f(location,0.2f,0.3f,0.8f,1.0f));
+    //editing Basic.shader (or ColorBlock.glsl) while the window is open rebuilds it in the background
+    ShaderHotReloader hotReloader(*compiler);
+    ShaderHotReloader::Handle shaderReload = 0;
+    bool hotReload = options.HotReload && !options.Headless && hotReloader.Start();
 
 
     float r = 0.0f;
     float increment = 0.05f;
-    /* Loop until the user closes the window */
-    while (!glfwWindowShouldClose(window))
+    FrameTimer timer;
+    timer.BeginRun();
+    int frame = 0;
+    /* Loop until the user closes the window, or until a headless run has rendered its frames */
+    while (options.Headless ? frame < options.Frames : !glfwWindowShouldClose(window))
     {
         /* Render here */
         glClear(GL_COLOR_BUFFER_BIT);
 
+        if (!shader)
+        {
+            ShaderCompiler::Status status = compiler->Poll(shaderJob);
+            if (status == ShaderCompiler::Status::Failed)
+                break;
+            unsigned int program = compiler->GetProgram(shaderJob);
+            if (status == ShaderCompiler::Status::Ready && options.Warmup && !warmup.IsWarm(program, { va.GetRendererID() }))
+            {
+                warmup.Add(program, "Basic.shader", { va.GetRendererID() });
+                warmup.Run(warmupBudgetMs);
+            }
+            else if (status == ShaderCompiler::Status::Ready)
+            {
+                useShader(program);
+                if (hotReload)
+                    shaderReload = hotReloader.Add("./res/shaders/Basic.shader", shader);
+            }
+        }
+        //between frames, so a frame never draws with half of an old and half of a new program
+        else if (hotReload && !hotReloader.Update().empty())
+        {
+            //an edit is waited on anyway, so the reloaded program is warmed right away
+            unsigned int program = hotReloader.GetProgram(shaderReload);
+            //Update() deleted the old one, its name is free to come back as a new program
+            warmup.Forget(shader);
+            if (options.Warmup)
+            {
+                warmup.Add(program, "Basic.shader (reloaded)", { va.GetRendererID() });
+                warmup.Run();
+            }
+            useShader(program);
+        }
+
 
 
         //glBegin(GL_TRIANGLES);
@@ -357,8 +684,37 @@ int main()
         //Drawing with index buffers
         //glDrawElements(GL_TRIANGLES, 6, GL_INT, nullptr);
         //ASSERT(GLLogCall());
-        GLCall(glUniform4f(location, r, 0.3f, 0.8f, 1.0f));
-        GLCall(glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, nullptr));
+        //doesn't wait for Basic.shader, the instanced path only needs its own program
+        if (instancedShader)
+        {
+            //no uniform per quad, every instance's color is 4 bytes in instanceBuffer
+            int perSide = (int)std::ceil(std::sqrt((double)options.Instances));
+            float cell = 2.0f / perSide;
+            uint8_t red = (uint8_t)(std::min(std::max(r, 0.0f), 1.0f) * 255.0f);
+            for (int i = 0; i < options.Instances; i++)
+            {
+                int column = i % perSide, row = i / perSide;
+                QuadInstance instance = { { -1.0f + (column + 0.5f) * cell, -1.0f + (row + 0.5f) * cell }, cell * 0.9f,
+                    { red, (uint8_t)(255 * column / perSide), 204, 255 } };
+                instanceBuffer.Push(instance);
+            }
+            instanceBuffer.Upload();
+            GLStateCache::Get().UseProgram(instancedShader);
+            warmup.BeginFirstUse(instancedShader, { va.GetRendererID() });
+            DrawElementsInstanced(va, ib.GetCount(), instanceBuffer.GetCount());
+            warmup.EndFirstUse();
+        }
+        else if (shader)
+        {
+            //with more draws, every block gets pushed first, then one Upload() and a BindRange() per draw
+            unsigned int colorOffset = colorBuffer.Push(ColorBlock{ { r, 0.3f, 0.8f, 1.0f } });
+            colorBuffer.Upload();
+            colorBuffer.BindRange(s_ColorBlockBinding, colorOffset, sizeof(ColorBlock));
+            //only the first two draws with each program are timed (and waited on), for PrintReport()
+            warmup.BeginFirstUse(shader, { va.GetRendererID() });
+            GLCall(glDrawElements(GL_TRIANGLES, ib.GetCount(), GL_UNSIGNED_INT, nullptr));
+            warmup.EndFirstUse();
+        }
 
         if (r > 1.0f)
             increment = -0.05f;
@@ -367,13 +723,68 @@ int main()
 
         r += increment;
 
+        UniformState::EndFrame();
+        GLStateCache::Get().EndFrame();
+        GLCheckFrame();
+        frame++;
+        if (options.Headless)
+        {
+            timer.EndFrame();
+            continue;
+        }
+
         /* Swap front and back buffers */
         glfwSwapBuffers(window);
         /* Poll for and process events */
         glfwPollEvents();
     }
+
+    if (options.Headless)
+    {
+        //wait for the queued draws so the total covers GPU work too
+        glFinish();
+        timer.EndRun();
+        timer.Print();
+
+        if (!options.DumpPath.empty())
+        {
+            std::vector<unsigned char> pixels;
+            offscreen.ReadPixels(pixels);
+            WriteImagePPM(options.DumpPath, offscreen.GetWidth(), offscreen.GetHeight(), pixels);
+        }
+    }
+
     //glDeleteShader(shader);
+    ForgetProgramReflection(shader);
     glDeleteProgram(shader);
-    glfwTerminate();
+    colorBuffer.Destroy();
+    //the context goes away before main's locals do
+    va.Reset();
+    vb.Reset();
+    ib.Reset();
+    instanceBuffer.Reset();
+    if (instancedShader)
+    {
+        ForgetProgramReflection(instancedShader);
+        glDeleteProgram(instancedShader);
+    }
+    warmup.PrintReport();
+    warmup.Destroy();
+    //the workers have to be done with their contexts before those go away
+    compiler.reset();
+    compileContexts.Destroy();
+    ProgramBinaryCache::Get().PrintStats();
+    ShaderPipelineCache::Get().PrintStats();
+    ShaderPipelineCache::Get().Destroy();
+    UniformState::PrintStats();
+    GLStateCache::Get().PrintStats();
+    DebugSink::Get().Stop();
+    if (options.Headless)
+    {
+        offscreen.Destroy();
+        headless.Destroy();
+    }
+    else
+        glfwTerminate();
     return 0;
 }
\ No newline at end of file
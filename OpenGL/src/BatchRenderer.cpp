@@ -0,0 +1,126 @@
+#include "BatchRenderer.h"
+#include "GLStateCache.h"
+#include "Renderer.h"
+#include "ShaderReflection.h"
+#include "UniformState.h"
+
+#include <algorithm>
+
+BatchRenderer::BatchRenderer(unsigned int program)
+    : m_Program(program),
+    m_VertexBuffer(nullptr, MaxQuads * 4 * sizeof(QuadVertex), GL_DYNAMIC_DRAW)
+{
+    //bound before the index buffer exists, creating it binds it to whatever VAO is current
+    m_VertexArray.Bind();
+
+    //0,1,2,2,3,0 for every quad, the same for every batch so it's built once
+    std::vector<unsigned int> indices(MaxQuads * 6);
+    for (unsigned int quad = 0; quad < MaxQuads; quad++)
+    {
+        unsigned int* index = &indices[quad * 6];
+        unsigned int first = quad * 4;
+        index[0] = first + 0;
+        index[1] = first + 1;
+        index[2] = first + 2;
+        index[3] = first + 2;
+        index[4] = first + 3;
+        index[5] = first + 0;
+    }
+    m_IndexBuffer = IndexBuffer(indices.data(), (unsigned int)indices.size());
+    m_VertexArray.AddBuffer(m_VertexBuffer, QuadVertex::Layout());
+    m_VertexArray.SetIndexBuffer(m_IndexBuffer);
+    m_VertexArray.Unbind();
+    ValidateVertexLayout(QuadVertex::Layout(), 0, program, "BatchRenderer program");
+
+    unsigned char white[4] = { 255, 255, 255, 255 };
+    GLCall(glGenTextures(1, &m_WhiteTexture));
+    GLStateCache::Get().BindTexture(0, GL_TEXTURE_2D, m_WhiteTexture);
+    GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST));
+    GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST));
+    GLCall(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, white));
+    for (unsigned int& texture : m_Textures)
+        texture = m_WhiteTexture;
+
+    //the samplers never change, slot i is always texture unit i
+    int units[MaxTextures];
+    for (unsigned int i = 0; i < MaxTextures; i++)
+        units[i] = (int)i;
+    const ProgramReflection* reflection = GetProgramReflection(program);
+    UniformHandle textures = reflection ? reflection->GetUniform("u_Textures") : UniformHandle();
+    if (textures.IsValid())
+    {
+        GLStateCache::Get().UseProgram(program);
+        GetUniformState(program)->Set1iv(textures, std::min((int)MaxTextures, textures.Count), units);
+    }
+
+    m_Staging.reserve(MaxQuads * 4);
+}
+
+BatchRenderer::~BatchRenderer()
+{
+    if (m_WhiteTexture)
+    {
+        GLStateCache::Get().ForgetTexture(m_WhiteTexture);
+        GLCall(glDeleteTextures(1, &m_WhiteTexture));
+    }
+}
+
+void BatchRenderer::SetTexture(unsigned int slot, unsigned int texture)
+{
+    ASSERT(slot > 0 && slot < MaxTextures);
+    if (m_Textures[slot] != texture)
+    {
+        //quads already staged were meant for the old texture
+        Flush();
+        m_Textures[slot] = texture;
+    }
+}
+
+void BatchRenderer::Begin()
+{
+    m_DrawCount = 0;
+    m_QuadCount = 0;
+}
+
+void BatchRenderer::DrawQuad(float x, float y, float width, float height, const float color[4], unsigned int textureSlot)
+{
+    if (m_Staging.size() == MaxQuads * 4)
+        Flush();
+
+    uint8_t rgba[4];
+    for (int i = 0; i < 4; i++)
+        rgba[i] = (uint8_t)(std::min(std::max(color[i], 0.0f), 1.0f) * 255.0f + 0.5f);
+    float slot = (float)textureSlot;
+
+    //counter clockwise from the bottom left, like positions[] in main()
+    m_Staging.push_back({ { x, y }, { 0.0f, 0.0f }, { rgba[0], rgba[1], rgba[2], rgba[3] }, slot });
+    m_Staging.push_back({ { x + width, y }, { 1.0f, 0.0f }, { rgba[0], rgba[1], rgba[2], rgba[3] }, slot });
+    m_Staging.push_back({ { x + width, y + height }, { 1.0f, 1.0f }, { rgba[0], rgba[1], rgba[2], rgba[3] }, slot });
+    m_Staging.push_back({ { x, y + height }, { 0.0f, 1.0f }, { rgba[0], rgba[1], rgba[2], rgba[3] }, slot });
+    m_QuadCount++;
+}
+
+void BatchRenderer::End()
+{
+    Flush();
+}
+
+void BatchRenderer::Flush()
+{
+    if (m_Staging.empty())
+        return;
+
+    //orphan first, the previous batch's draw may still be reading the old store
+    m_VertexBuffer.Orphan();
+    m_VertexBuffer.Upload(m_Staging.data(), (unsigned int)(m_Staging.size() * sizeof(QuadVertex)));
+
+    //after the first flush these are all already bound, the cache drops them
+    GLStateCache& state = GLStateCache::Get();
+    for (unsigned int i = 0; i < MaxTextures; i++)
+        state.BindTexture(i, GL_TEXTURE_2D, m_Textures[i]);
+    state.UseProgram(m_Program);
+    m_VertexArray.Bind();
+    GLCall(glDrawElements(GL_TRIANGLES, (int)(m_Staging.size() / 4 * 6), GL_UNSIGNED_INT, nullptr));
+    m_DrawCount++;
+    m_Staging.clear();
+}
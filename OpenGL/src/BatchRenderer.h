@@ -0,0 +1,71 @@
+#pragma once
+#include "IndexBuffer.h"
+#include "VertexArray.h"
+#include "VertexBuffer.h"
+#include "VertexLayout.h"
+#include <cstdint>
+#include <vector>
+
+//One corner of a batched quad, what Batch.shader reads
+struct QuadVertex
+{
+    float Position[2];
+    float TexCoord[2];
+    uint8_t Color[4];
+    float TexIndex; //texture slot, a float because that's what every driver fetches fastest
+
+    using Layout = VertexLayout<Float2, Float2, UByte4Norm, Float1>;
+};
+static_assert(sizeof(QuadVertex) == QuadVertex::Layout::Stride, "QuadVertex has padding its layout doesn't know about");
+
+//Draws any number of 2D quads with as few draw calls as possible.
+//
+//DrawQuad() only writes four vertices into a CPU staging array. End() (or a
+//full staging array) uploads them with one glBufferSubData into an orphaned
+//vertex buffer and draws them all with one glDrawElements. The index buffer
+//never changes: it's generated once for MaxQuads quads in the 0,1,2,2,3,0
+//pattern, so MaxQuads quads cost one draw call.
+//Each quad picks a texture slot; slot 0 is white, so untextured quads are
+//just their color. A flush leaves its program, VAO and textures bound.
+//Owns its buffers like VertexBuffer does, so it's created
+//and destroyed with a current context. Main thread only.
+class BatchRenderer
+{
+public:
+    static const unsigned int MaxQuads = 10000;
+    static const unsigned int MaxTextures = 8;
+
+    //program is Batch.shader (or anything reading QuadVertex the same way),
+    //its inputs are checked against QuadVertex::Layout
+    explicit BatchRenderer(unsigned int program);
+    ~BatchRenderer();
+
+    BatchRenderer(const BatchRenderer&) = delete;
+    BatchRenderer& operator=(const BatchRenderer&) = delete;
+
+    //slot is 1 to MaxTextures - 1, texture a GL_TEXTURE_2D name
+    void SetTexture(unsigned int slot, unsigned int texture);
+
+    //clears the draw and quad counts
+    void Begin();
+    //x, y is the bottom left corner in clip space, color is RGBA 0-1
+    void DrawQuad(float x, float y, float width, float height, const float color[4], unsigned int textureSlot = 0);
+    void End();
+
+    //since Begin()
+    unsigned int GetDrawCount() const { return m_DrawCount; }
+    unsigned int GetQuadCount() const { return m_QuadCount; }
+private:
+    void Flush();
+
+    unsigned int m_Program = 0;
+    VertexArray m_VertexArray;
+    VertexBuffer m_VertexBuffer;
+    IndexBuffer m_IndexBuffer;
+    unsigned int m_WhiteTexture = 0;
+    unsigned int m_Textures[MaxTextures] = {};
+
+    std::vector<QuadVertex> m_Staging;
+    unsigned int m_DrawCount = 0;
+    unsigned int m_QuadCount = 0;
+};
@@ -0,0 +1,646 @@
+#include "Benchmarks.h"
+#include "BatchRenderer.h"
+#include "CommandList.h"
+#include "DrawBucket.h"
+#include "GLStateCache.h"
+#include "IndexBuffer.h"
+#include "MappedFile.h"
+#include "Renderer.h"
+#include "Shader.h"
+#include "ShaderParser.h"
+#include "ShaderPipeline.h"
+#include "ShaderReflection.h"
+#include "ShaderVariants.h"
+#include "UniformState.h"
+#include "VertexArray.h"
+#include "VertexBuffer.h"
+#include "VertexLayout.h"
+
+#include <chrono>
+#include <cmath>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <vector>
+
+//The parser ParseShader() used to be: getline, two finds per line and a
+//stringstream per stage. Kept only as the baseline to compare against.
+static ShaderProgramSource ParseShaderGetline(const std::string& filepath)
+{
+    std::ifstream stream(filepath);
+    enum class ShaderType
+    {
+        NONE=-1, VERTEX=0, FRAGMENT=1
+    };
+    std::string line;
+    std::stringstream ss[2];
+    ShaderType type=ShaderType::NONE;
+
+    while (getline(stream, line))
+    {
+        if (line.find("#shader") != std::string::npos)
+        {
+            if (line.find("vertex") != std::string::npos)
+                type = ShaderType::VERTEX;
+            else if (line.find("fragment") != std::string::npos)
+                type = ShaderType::FRAGMENT;
+        }
+        //the original indexed ss[-1] here for text before the first directive
+        else if (type != ShaderType::NONE)
+        {
+            ss[(int)type] << line << '\n';
+        }
+    }
+    return { ss[0].str(),ss[1].str() };
+}
+
+//Basic.shader with each stage padded out by comment and code lines up to roughly targetBytes
+static void WriteLargeShader(const std::string& filepath, size_t targetBytes)
+{
+    std::ofstream stream(filepath, std::ios::binary);
+    const char* vertex =
+        "#version 330 core\n"
+        "layout(location = 0 ) in vec4 position;\n";
+    const char* fragment =
+        "#version 330 core\n"
+        "layout(location = 0) out vec4 color;\n"
+        "uniform vec4 u_Color;\n";
+    const char* filler =
+        "    // some padding to make the file big, like a long shared library of functions\n"
+        "    float helper(float x) { return x * 0.5 + 0.25; }\n";
+    size_t fillerCount = targetBytes / 2 / strlen(filler) + 1;
+
+    stream << "#shader vertex\n" << vertex;
+    for (size_t i = 0; i < fillerCount; i++)
+        stream << filler;
+    stream << "void main()\n{\n    gl_Position = position;\n}\n\n";
+    stream << "#shader fragment\n" << fragment;
+    for (size_t i = 0; i < fillerCount; i++)
+        stream << filler;
+    stream << "void main()\n{\n    color = u_Color;\n}\n";
+}
+
+template<typename F>
+static double BestOfMs(int iterations, F&& run)
+{
+    double best = 1e30;
+    for (int i = 0; i < iterations; i++)
+    {
+        auto start = std::chrono::steady_clock::now();
+        run();
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        best = std::min(best, elapsed.count());
+    }
+    return best;
+}
+
+static void BenchmarkParserFile(const std::string& filepath)
+{
+    MappedFile probe(filepath);
+    if (!probe.IsOpen())
+    {
+        std::cout << "Failed to open " << filepath << std::endl;
+        return;
+    }
+    double megabytes = probe.GetData().size() / (1024.0 * 1024.0);
+    probe.Close();
+    int iterations = megabytes < 1.0 ? 200 : 10;
+
+    //keeps the compiler from dropping the parse, and checks both parsers agree
+    size_t sink = 0;
+    ShaderProgramSource legacy = ParseShaderGetline(filepath);
+    ShaderProgramSource current = ParseShader(filepath);
+    bool same = legacy.VertexSource == current.VertexSource && legacy.FragmentSource == current.FragmentSource;
+
+    double getlineMs = BestOfMs(iterations, [&] { sink += ParseShaderGetline(filepath).VertexSource.size(); });
+    double parseMs = BestOfMs(iterations, [&] { sink += ParseShader(filepath).VertexSource.size(); });
+    //the scanner alone on a file that's already mapped, what hands views to glShaderSource
+    MappedFile file(filepath);
+    double scanMs = BestOfMs(iterations, [&] { sink += ParseShaderStages(file.GetData()).size(); });
+
+    printf("%s (%.2f MB)%s\n", filepath.c_str(), megabytes, same ? "" : "  [outputs differ!]");
+    printf("  getline/stringstream  %9.3f ms  %8.1f MB/s\n", getlineMs, megabytes * 1000.0 / getlineMs);
+    printf("  ParseShader (mmap)    %9.3f ms  %8.1f MB/s  %.1fx\n", parseMs, megabytes * 1000.0 / parseMs, getlineMs / parseMs);
+    printf("  ParseShaderStages     %9.3f ms  %8.1f MB/s  %.1fx\n", scanMs, megabytes * 1000.0 / scanMs, getlineMs / scanMs);
+    if (sink == 0)
+        printf("  (empty output)\n");
+}
+
+int RunParserBenchmark(const std::string& filepath)
+{
+    if (!filepath.empty())
+    {
+        BenchmarkParserFile(filepath);
+        return 0;
+    }
+
+    const size_t sizes[] = { 4 * 1024, 256 * 1024, 16 * 1024 * 1024 };
+    for (size_t size : sizes)
+    {
+        std::string generated = "parser_bench_" + std::to_string(size / 1024) + "k.shader";
+        WriteLargeShader(generated, size);
+        BenchmarkParserFile(generated);
+        std::remove(generated.c_str());
+    }
+    return 0;
+}
+
+//CreateShader() without the program binary cache, so every pair really links
+static unsigned int LinkProgram(const std::string& vertexSource, const std::string& fragmentSource)
+{
+    unsigned int program = glCreateProgram();
+    unsigned int vs = CompileShader(GL_VERTEX_SHADER, vertexSource);
+    unsigned int fs = CompileShader(GL_FRAGMENT_SHADER, fragmentSource);
+    GLCall(glAttachShader(program, vs));
+    GLCall(glAttachShader(program, fs));
+    GLCall(glLinkProgram(program));
+    GLCall(glDeleteShader(vs));
+    GLCall(glDeleteShader(fs));
+    ReflectProgram(program);
+    return program;
+}
+
+int RunPipelineBenchmark(int variants)
+{
+    if (!ShaderPipelineCache::IsSupported())
+    {
+        std::cout << "No ARB_separate_shader_objects, nothing to compare" << std::endl;
+        return 1;
+    }
+    variants = std::max(1, variants);
+
+    //a #define per variant is enough to make every source distinct, so no
+    //driver side shader cache can hand back an earlier compile
+    ShaderProgramSource basic = ParseShader("./res/shaders/Basic.shader");
+    std::vector<std::string> vertexSources, fragmentSources;
+    for (int i = 0; i < variants; i++)
+    {
+        std::string define = "#define VARIANT " + std::to_string(i) + "\n";
+        vertexSources.push_back(InjectDefines(basic.VertexSource, define));
+        fragmentSources.push_back(InjectDefines(basic.FragmentSource, define));
+    }
+
+    //glFinish so a driver that compiles lazily or on its own threads is done before the clock stops
+    std::vector<unsigned int> programs;
+    auto start = std::chrono::steady_clock::now();
+    for (const std::string& vertex : vertexSources)
+        for (const std::string& fragment : fragmentSources)
+            programs.push_back(LinkProgram(vertex, fragment));
+    glFinish();
+    std::chrono::duration<double, std::milli> linkedMs = std::chrono::steady_clock::now() - start;
+
+    ShaderPipelineCache& pipelines = ShaderPipelineCache::Get();
+    unsigned int failed = 0;
+    start = std::chrono::steady_clock::now();
+    for (const std::string& vertex : vertexSources)
+        for (const std::string& fragment : fragmentSources)
+            failed += pipelines.GetPipeline(vertex, fragment) == 0;
+    glFinish();
+    std::chrono::duration<double, std::milli> pipelineMs = std::chrono::steady_clock::now() - start;
+
+    printf("%d vertex x %d fragment variants\n", variants, variants);
+    printf("  linked programs     %4d links  %9.3f ms\n", variants * variants, linkedMs.count());
+    printf("  separable stages    %4d links  %9.3f ms  %.1fx\n", variants * 2, pipelineMs.count(),
+        linkedMs.count() / pipelineMs.count());
+    if (failed)
+        printf("  %u pipelines failed to build\n", failed);
+
+    for (unsigned int program : programs)
+    {
+        ForgetProgramReflection(program);
+        GLCall(glDeleteProgram(program));
+    }
+    pipelines.Destroy();
+    return failed ? 1 : 0;
+}
+
+//quad i of a grid of about quads quads covering clip space
+static void GridQuad(int quads, int i, float& x, float& y, float& size, float color[4])
+{
+    int perSide = (int)std::ceil(std::sqrt((double)quads));
+    int column = i % perSide, row = i / perSide;
+    size = 2.0f / perSide;
+    x = -1.0f + column * size;
+    y = -1.0f + row * size;
+    color[0] = (float)column / perSide;
+    color[1] = (float)row / perSide;
+    color[2] = 0.5f;
+    color[3] = 1.0f;
+    //a little smaller than the cell so the grid shows in a --dump
+    size *= 0.9f;
+}
+
+//What the app did before batching: one small buffer holding one quad,
+//overwritten and drawn once per quad
+struct PerQuadRenderer
+{
+    VertexArray Vertices;
+    VertexBuffer Buffer{ nullptr, 4 * sizeof(QuadVertex), GL_DYNAMIC_DRAW };
+    IndexBuffer Indices;
+
+    PerQuadRenderer()
+    {
+        unsigned int indices[] = { 0, 1, 2, 2, 3, 0 };
+        Vertices.Bind();
+        Indices = IndexBuffer(indices, 6);
+        Vertices.AddBuffer(Buffer, QuadVertex::Layout());
+        Vertices.SetIndexBuffer(Indices);
+    }
+
+    void Frame(unsigned int program, int quads)
+    {
+        GLStateCache::Get().UseProgram(program);
+        Vertices.Bind();
+        for (int i = 0; i < quads; i++)
+        {
+            float x, y, size, color[4];
+            GridQuad(quads, i, x, y, size, color);
+            uint8_t r = (uint8_t)(color[0] * 255.0f), g = (uint8_t)(color[1] * 255.0f), b = 128, a = 255;
+            QuadVertex vertices[4] = {
+                { { x, y }, { 0.0f, 0.0f }, { r, g, b, a }, 0.0f },
+                { { x + size, y }, { 1.0f, 0.0f }, { r, g, b, a }, 0.0f },
+                { { x + size, y + size }, { 1.0f, 1.0f }, { r, g, b, a }, 0.0f },
+                { { x, y + size }, { 0.0f, 1.0f }, { r, g, b, a }, 0.0f },
+            };
+            Buffer.Upload(vertices, sizeof(vertices));
+            GLCall(glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, nullptr));
+        }
+    }
+};
+
+static void BatchFrame(BatchRenderer& batch, int quads)
+{
+    batch.Begin();
+    for (int i = 0; i < quads; i++)
+    {
+        float x, y, size, color[4];
+        GridQuad(quads, i, x, y, size, color);
+        batch.DrawQuad(x, y, size, size, color);
+    }
+    batch.End();
+}
+
+int RunBatchBenchmark(int quads)
+{
+    ShaderProgramSource source = ParseShader("./res/shaders/Batch.shader");
+    unsigned int program = CreateShader(source.VertexSource, source.FragmentSource);
+    if (!IsLinked(program))
+    {
+        if (program)
+        {
+            GLCall(glDeleteProgram(program));
+        }
+        return 1;
+    }
+
+    const int frames = 20;
+    printf("%d quads per frame, best of %d frames\n", quads, frames);
+    {
+        //the batch renderer binds the samplers, the per-quad path reuses that
+        BatchRenderer batch(program);
+        PerQuadRenderer perQuad;
+
+        //one frame each first, the first draw is where the driver compiles
+        perQuad.Frame(program, quads);
+        BatchFrame(batch, quads);
+        glFinish();
+
+        //submitting is the CPU cost batching is about, the total adds the GPU
+        //(or llvmpipe) filling the same pixels either way
+        double perQuadSubmitMs = 1e30, batchSubmitMs = 1e30;
+        auto timeFrame = [&](double& submitMs, auto&& draw)
+        {
+            GLCall(glClear(GL_COLOR_BUFFER_BIT));
+            auto start = std::chrono::steady_clock::now();
+            draw();
+            std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+            submitMs = std::min(submitMs, elapsed.count());
+            glFinish();
+        };
+        double perQuadMs = BestOfMs(frames, [&] { timeFrame(perQuadSubmitMs, [&] { perQuad.Frame(program, quads); }); });
+        double batchMs = BestOfMs(frames, [&] { timeFrame(batchSubmitMs, [&] { BatchFrame(batch, quads); }); });
+
+        printf("                        draws  submit ms    total ms  quads/s (total)\n");
+        printf("  draw per quad  %10d  %9.3f  %10.3f  %12.0f\n", quads, perQuadSubmitMs, perQuadMs, quads * 1000.0 / perQuadMs);
+        printf("  batched        %10u  %9.3f  %10.3f  %12.0f\n", batch.GetDrawCount(), batchSubmitMs, batchMs, quads * 1000.0 / batchMs);
+        printf("  batching submits %.1fx faster, %.1fx overall\n", perQuadSubmitMs / batchSubmitMs, perQuadMs / batchMs);
+    }
+
+    ForgetProgramReflection(program);
+    GLCall(glDeleteProgram(program));
+    return 0;
+}
+
+//A few of everything a draw can switch between, for RunSortBenchmark()
+struct SortScene
+{
+    static const unsigned int Programs = 4;
+    static const unsigned int VertexArrays = 4;
+    static const unsigned int Textures = 8;
+
+    unsigned int Program[Programs] = {};
+    std::vector<VertexBuffer> Vertices;
+    std::vector<VertexArray> Arrays;
+    IndexBuffer Indices;
+    unsigned int Texture[Textures] = {};
+
+    //each program is its own link of Batch.shader, the driver can't tell they're the same
+    bool Create()
+    {
+        ShaderProgramSource source = ParseShader("./res/shaders/Batch.shader");
+        for (unsigned int& program : Program)
+        {
+            program = CreateShader(source.VertexSource, source.FragmentSource);
+            if (!IsLinked(program))
+                return false;
+        }
+
+        //one small quad per VAO, in a different quadrant each, so the GPU side stays cheap
+        Vertices.reserve(VertexArrays);
+        Arrays.resize(VertexArrays);
+        unsigned int indices[] = { 0, 1, 2, 2, 3, 0 };
+        for (unsigned int i = 0; i < VertexArrays; i++)
+        {
+            float x = i % 2 ? 0.4f : -0.6f, y = i / 2 ? 0.4f : -0.6f, size = 0.2f;
+            QuadVertex quad[4] = {
+                { { x, y }, { 0.0f, 0.0f }, { 255, 255, 255, 255 }, 0.0f },
+                { { x + size, y }, { 1.0f, 0.0f }, { 255, 255, 255, 255 }, 0.0f },
+                { { x + size, y + size }, { 1.0f, 1.0f }, { 255, 255, 255, 255 }, 0.0f },
+                { { x, y + size }, { 0.0f, 1.0f }, { 255, 255, 255, 255 }, 0.0f },
+            };
+            Vertices.emplace_back(quad, (unsigned int)sizeof(quad));
+            Arrays[i].Bind();
+            //created with the first VAO bound, every other one just points at it
+            if (i == 0)
+                Indices = IndexBuffer(indices, 6);
+            Arrays[i].AddBuffer(Vertices[i], QuadVertex::Layout());
+            Arrays[i].SetIndexBuffer(Indices);
+        }
+
+        GLCall(glGenTextures(Textures, Texture));
+        for (unsigned int i = 0; i < Textures; i++)
+        {
+            unsigned char color[4] = { (unsigned char)(i * 32), (unsigned char)(255 - i * 32), 128, 255 };
+            GLStateCache::Get().BindTexture(0, GL_TEXTURE_2D, Texture[i]);
+            GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST));
+            GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST));
+            GLCall(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, color));
+        }
+        return true;
+    }
+
+    void Destroy()
+    {
+        for (unsigned int texture : Texture)
+            GLStateCache::Get().ForgetTexture(texture);
+        GLCall(glDeleteTextures(Textures, Texture));
+        Arrays.clear();
+        Vertices.clear();
+        Indices.Reset();
+        for (unsigned int program : Program)
+        {
+            if (!program)
+                continue;
+            ForgetProgramReflection(program);
+            GLCall(glDeleteProgram(program));
+        }
+    }
+};
+
+int RunSortBenchmark(int draws)
+{
+    SortScene scene;
+    if (!scene.Create())
+    {
+        scene.Destroy();
+        return 1;
+    }
+
+    //the same random draws every frame, in the order a scene walk might produce them
+    std::mt19937 random(1234);
+    std::vector<std::pair<uint64_t, DrawCommand>> frameDraws(draws);
+    for (auto& [key, command] : frameDraws)
+    {
+        unsigned int program = random() % SortScene::Programs;
+        unsigned int vertexArray = random() % SortScene::VertexArrays;
+        unsigned int texture = random() % SortScene::Textures;
+        float depth = (float)(random() % 1000) / 1000.0f;
+        command.Program = scene.Program[program];
+        command.VertexArray = scene.Arrays[vertexArray].GetRendererID();
+        command.Texture = scene.Texture[texture];
+        command.IndexCount = 6;
+        key = MakeDrawKey(0, program, texture, vertexArray, depth);
+    }
+
+    DrawBucket bucket;
+    bucket.Reserve(draws);
+    auto submitFrame = [&]
+    {
+        for (const auto& [key, command] : frameDraws)
+            bucket.Submit(key, command);
+    };
+
+    const int frames = 20;
+    printf("%d draws per frame over %u programs, %u VAOs and %u textures, best of %d frames\n",
+        draws, SortScene::Programs, SortScene::VertexArrays, SortScene::Textures, frames);
+
+    //one frame first, the first draw is where the driver compiles
+    submitFrame();
+    bucket.Flush();
+    glFinish();
+
+    DrawBucket::Stats unsortedStats, sortedStats;
+    double unsortedSubmitMs = 1e30, sortedSubmitMs = 1e30, sortMs = 1e30;
+    auto timeFrame = [&](bool sort, double& submitMs, DrawBucket::Stats& stats)
+    {
+        GLCall(glClear(GL_COLOR_BUFFER_BIT));
+        submitFrame();
+        auto start = std::chrono::steady_clock::now();
+        bucket.Flush(sort);
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        submitMs = std::min(submitMs, elapsed.count());
+        stats = bucket.GetStats();
+        if (sort)
+            sortMs = std::min(sortMs, stats.SortMs);
+        glFinish();
+    };
+    double unsortedMs = BestOfMs(frames, [&] { timeFrame(false, unsortedSubmitMs, unsortedStats); });
+    double sortedMs = BestOfMs(frames, [&] { timeFrame(true, sortedSubmitMs, sortedStats); });
+
+    //the radix sort against the standard library on the same keys
+    std::vector<std::pair<uint64_t, unsigned int>> keys(draws);
+    double stdSortMs = BestOfMs(frames, [&]
+    {
+        for (int i = 0; i < draws; i++)
+            keys[i] = { frameDraws[i].first, (unsigned int)i };
+        std::stable_sort(keys.begin(), keys.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+    });
+
+    printf("                  programs      VAOs  textures  submit ms    total ms\n");
+    printf("  submit order  %10u %9u %9u  %9.3f  %10.3f\n", unsortedStats.ProgramChanges,
+        unsortedStats.VertexArrayChanges, unsortedStats.TextureChanges, unsortedSubmitMs, unsortedMs);
+    printf("  key order     %10u %9u %9u  %9.3f  %10.3f\n", sortedStats.ProgramChanges,
+        sortedStats.VertexArrayChanges, sortedStats.TextureChanges, sortedSubmitMs, sortedMs);
+    printf("  radix sort %.3f ms (std::stable_sort %.3f ms), sorted submits %.1fx faster including it\n",
+        sortMs, stdSortMs, unsortedSubmitMs / sortedSubmitMs);
+
+    scene.Destroy();
+    return 0;
+}
+
+//What a scene walk works out per object before it can be drawn
+struct SceneObject
+{
+    float Orbit, Speed, Phase, Size;
+    float Color[4];
+};
+
+//a few joints of made up animation, enough CPU work per object that preparing
+//the draws costs about as much as it would in a real scene walk.
+//False when the object ends up off screen
+static bool PrepareObject(const SceneObject& object, float time, float& x, float& y, float& scale)
+{
+    x = 0.0f;
+    y = 0.0f;
+    float angle = object.Phase + time * object.Speed, radius = object.Orbit;
+    for (int joint = 0; joint < 8; joint++)
+    {
+        x += std::cos(angle) * radius;
+        y += std::sin(angle) * radius;
+        angle *= 1.3f;
+        radius *= 0.5f;
+    }
+    scale = object.Size * (0.75f + 0.25f * std::sin(time + object.Phase));
+    return std::fabs(x) - scale < 1.0f && std::fabs(y) - scale < 1.0f;
+}
+
+int RunCommandBenchmark(int objects, unsigned int threads)
+{
+    ShaderProgramSource source = ParseShader("./res/shaders/Sprite.shader");
+    unsigned int program = CreateShader(source.VertexSource, source.FragmentSource);
+    const ProgramReflection* reflection = GetProgramReflection(program);
+    if (!IsLinked(program) || !reflection)
+    {
+        if (program)
+        {
+            ForgetProgramReflection(program);
+            GLCall(glDeleteProgram(program));
+        }
+        return 1;
+    }
+    UniformHandle transform = reflection->GetUniform("u_Transform");
+    UniformHandle color = reflection->GetUniform("u_Color");
+    UniformState& uniforms = *GetUniformState(program);
+
+    //main()'s quad
+    float positions[] = { -0.5f, -0.5f, 0.5f, -0.5f, 0.5f, 0.5f, -0.5f, 0.5f };
+    unsigned int indices[] = { 0, 1, 2, 2, 3, 0 };
+    VertexArray vertexArray;
+    VertexBuffer vertices(positions, sizeof(positions));
+    vertexArray.Bind();
+    IndexBuffer indexBuffer(indices, 6);
+    vertexArray.AddBuffer(vertices, VertexLayout<Float2>());
+    vertexArray.SetIndexBuffer(indexBuffer);
+
+    std::mt19937 random(1234);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    std::vector<SceneObject> scene(objects);
+    for (SceneObject& object : scene)
+        object = { 0.2f + 0.8f * unit(random), 0.5f + unit(random), 6.28f * unit(random), 0.01f + 0.02f * unit(random),
+            { unit(random), unit(random), 0.5f + 0.5f * unit(random), 1.0f } };
+
+    float time = 0.0f;
+    auto record = [&](CommandList& list, unsigned int begin, unsigned int end)
+    {
+        //every list sets its own state, it can't know what the list before it left bound
+        list.BindProgram(program);
+        list.BindVertexArray(vertexArray.GetRendererID());
+        for (unsigned int i = begin; i < end; i++)
+        {
+            const SceneObject& object = scene[i];
+            float x, y, scale;
+            if (!PrepareObject(object, time, x, y, scale))
+                continue;
+            list.SetUniform4f(transform.Location, x, y, scale, 0.0f);
+            list.SetUniform4f(color.Location, object.Color[0], object.Color[1], object.Color[2], object.Color[3]);
+            list.DrawIndexed(6);
+        }
+    };
+    //the same walk issuing GL calls as it goes, what the render loop would do without command lists
+    auto direct = [&]
+    {
+        GLStateCache::Get().UseProgram(program);
+        vertexArray.Bind();
+        for (const SceneObject& object : scene)
+        {
+            float x, y, scale;
+            if (!PrepareObject(object, time, x, y, scale))
+                continue;
+            uniforms.Set4f(transform, x, y, scale, 0.0f);
+            uniforms.Set4f(color, object.Color[0], object.Color[1], object.Color[2], object.Color[3]);
+            GLCall(glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, nullptr));
+        }
+    };
+
+    CommandRecorder single(1);
+    CommandRecorder parallel(threads);
+    const int frames = 20;
+    printf("%d objects per frame, %u recording threads, best of %d frames\n", objects, parallel.GetThreadCount(), frames);
+
+    //one frame first, the first draw is where the driver compiles
+    direct();
+    glFinish();
+    GLStateCache::Get().EndFrame();
+    UniformState::EndFrame();
+
+    auto timeFrame = [&](CommandRecorder* recorder, double& recordMs, double& executeMs)
+    {
+        GLCall(glClear(GL_COLOR_BUFFER_BIT));
+        time += 0.016f;
+        auto start = std::chrono::steady_clock::now();
+        if (recorder)
+        {
+            recorder->Record((unsigned int)objects, record);
+            auto recorded = std::chrono::steady_clock::now();
+            recordMs = std::min(recordMs, std::chrono::duration<double, std::milli>(recorded - start).count());
+            recorder->Execute();
+            executeMs = std::min(executeMs, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - recorded).count());
+        }
+        else
+        {
+            direct();
+            executeMs = std::min(executeMs, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+        }
+        glFinish();
+        GLStateCache::Get().EndFrame();
+        UniformState::EndFrame();
+    };
+    double directRecordMs = 0.0, directExecuteMs = 1e30;
+    double singleRecordMs = 1e30, singleExecuteMs = 1e30;
+    double parallelRecordMs = 1e30, parallelExecuteMs = 1e30;
+    double directMs = BestOfMs(frames, [&] { timeFrame(nullptr, directRecordMs, directExecuteMs); });
+    double singleMs = BestOfMs(frames, [&] { timeFrame(&single, singleRecordMs, singleExecuteMs); });
+    double parallelMs = BestOfMs(frames, [&] { timeFrame(&parallel, parallelRecordMs, parallelExecuteMs); });
+
+    printf("                        record ms  execute ms    total ms\n");
+    printf("  GL calls directly     %9s  %10.3f  %10.3f\n", "-", directExecuteMs, directMs);
+    printf("  1 list                %9.3f  %10.3f  %10.3f\n", singleRecordMs, singleExecuteMs, singleMs);
+    char parallelLabel[32];
+    snprintf(parallelLabel, sizeof(parallelLabel), "%u lists", parallel.GetThreadCount());
+    printf("  %-20s  %9.3f  %10.3f  %10.3f\n", parallelLabel, parallelRecordMs, parallelExecuteMs, parallelMs);
+    printf("  %u commands in %zu bytes, recording %.1fx faster on %u threads\n", parallel.GetCommandCount(),
+        parallel.GetSize(), singleRecordMs / parallelRecordMs, parallel.GetThreadCount());
+    GLStateCache::Get().PrintStats();
+    UniformState::PrintStats();
+
+    vertexArray.Reset();
+    vertices.Reset();
+    indexBuffer.Reset();
+    ForgetProgramReflection(program);
+    GLCall(glDeleteProgram(program));
+    return 0;
+}
@@ -0,0 +1,29 @@
+#pragma once
+#include <string>
+
+//Microbenchmarks that run from the command line instead of the render loop.
+//Each prints its own results and returns the process exit code.
+
+//ParseShader() against the old getline/stringstream parser.
+//With an empty path it generates shader files of a few sizes from Basic.shader.
+int RunParserBenchmark(const std::string& filepath);
+
+//N vertex x N fragment variants of Basic.shader: one linked program per pair
+//against separable stages and program pipelines (ShaderPipelineCache).
+//Needs a current context, returns 1 if the driver has no separate shader objects.
+int RunPipelineBenchmark(int variants);
+
+//quads quads per frame through BatchRenderer, against a draw call per quad.
+//Needs a current context with a framebuffer bound
+int RunBatchBenchmark(int quads);
+
+//draws draws a frame, each with one of a few programs, VAOs and textures picked
+//at random, replayed by DrawBucket in submission order and in key order.
+//Needs a current context with a framebuffer bound
+int RunSortBenchmark(int draws);
+
+//objects objects animated and culled per frame, their draws issued straight
+//to GL, recorded into one CommandList, and recorded by threads threads
+//(0 is one per core) with CommandRecorder, then executed on this thread.
+//Needs a current context with a framebuffer bound
+int RunCommandBenchmark(int objects, unsigned int threads);
@@ -0,0 +1,215 @@
+#include "CommandList.h"
+#include "GLStateCache.h"
+#include "Renderer.h"
+#include "UniformState.h"
+
+#include <algorithm>
+
+void CommandList::Reset()
+{
+    for (Block& block : m_Blocks)
+        block.Used = 0;
+    m_Block = 0;
+    m_CommandCount = 0;
+}
+
+size_t CommandList::GetSize() const
+{
+    size_t size = 0;
+    for (const Block& block : m_Blocks)
+        size += block.Used;
+    return size;
+}
+
+unsigned char* CommandList::Allocate(size_t size)
+{
+    ASSERT(size <= BlockSize);
+    if (m_Blocks.empty())
+        m_Blocks.emplace_back().Data.reset(new unsigned char[BlockSize]);
+    if (m_Blocks[m_Block].Used + size > BlockSize)
+    {
+        m_Block++;
+        if (m_Block == m_Blocks.size())
+            m_Blocks.emplace_back().Data.reset(new unsigned char[BlockSize]);
+    }
+    Block& block = m_Blocks[m_Block];
+    unsigned char* memory = block.Data.get() + block.Used;
+    block.Used += size;
+    return memory;
+}
+
+unsigned int ExecuteCommandLists(const CommandList* const* lists, size_t count)
+{
+    GLStateCache& state = GLStateCache::Get();
+    //the shadow of the program bound last, nullptr until a list binds one
+    UniformState* uniforms = nullptr;
+    unsigned int draws = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        lists[i]->ForEach([&](const CommandHeader& header, const void* payload)
+        {
+            switch (header.Type)
+            {
+            case CommandType::BindProgram:
+            {
+                unsigned int program = ((const BindProgramCommand*)payload)->Program;
+                state.UseProgram(program);
+                uniforms = GetUniformState(program);
+                break;
+            }
+            case CommandType::BindVertexArray:
+                state.BindVertexArray(((const BindVertexArrayCommand*)payload)->VertexArray);
+                break;
+            case CommandType::BindTexture:
+            {
+                const BindTextureCommand* command = (const BindTextureCommand*)payload;
+                state.BindTexture(command->Unit, GL_TEXTURE_2D, command->Texture);
+                break;
+            }
+            case CommandType::BindUniformRange:
+            {
+                const BindUniformRangeCommand* command = (const BindUniformRangeCommand*)payload;
+                state.BindBufferRange(GL_UNIFORM_BUFFER, command->Binding, command->Buffer, command->Offset, command->Size);
+                break;
+            }
+            case CommandType::SetUniform1i:
+            {
+                const SetUniform1iCommand* command = (const SetUniform1iCommand*)payload;
+                UniformHandle uniform;
+                uniform.Location = command->Location;
+                if (uniforms)
+                    uniforms->Set1i(uniform, command->Value);
+                else
+                {
+                    GLCall(glUniform1i(command->Location, command->Value));
+                }
+                break;
+            }
+            case CommandType::SetUniform4f:
+            {
+                const SetUniform4fCommand* command = (const SetUniform4fCommand*)payload;
+                UniformHandle uniform;
+                uniform.Location = command->Location;
+                if (uniforms)
+                    uniforms->Set4f(uniform, command->Value[0], command->Value[1], command->Value[2], command->Value[3]);
+                else
+                {
+                    GLCall(glUniform4fv(command->Location, 1, command->Value));
+                }
+                break;
+            }
+            case CommandType::DrawIndexed:
+            {
+                const DrawIndexedCommand* command = (const DrawIndexedCommand*)payload;
+                const void* indices = (const void*)(size_t)(command->FirstIndex * sizeof(unsigned int));
+                if (command->InstanceCount == 1)
+                {
+                    GLCall(glDrawElements(GL_TRIANGLES, command->IndexCount, GL_UNSIGNED_INT, indices));
+                }
+                else
+                {
+                    GLCall(glDrawElementsInstanced(GL_TRIANGLES, command->IndexCount, GL_UNSIGNED_INT, indices, command->InstanceCount));
+                }
+                draws++;
+                break;
+            }
+            }
+        });
+    }
+    return draws;
+}
+
+CommandRecorder::CommandRecorder(unsigned int threadCount)
+{
+    if (threadCount == 0)
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    m_Lists.resize(threadCount);
+    for (const CommandList& list : m_Lists)
+        m_ListPointers.push_back(&list);
+
+    //the calling thread is worker 0
+    for (unsigned int i = 1; i < threadCount; i++)
+        m_Workers.emplace_back(&CommandRecorder::WorkerLoop, this, i);
+}
+
+CommandRecorder::~CommandRecorder()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_JobMutex);
+        m_Quit = true;
+    }
+    m_JobReady.notify_all();
+    for (std::thread& worker : m_Workers)
+        worker.join();
+}
+
+void CommandRecorder::RecordRange(unsigned int worker)
+{
+    CommandList& list = m_Lists[worker];
+    list.Reset();
+    unsigned int threads = GetThreadCount();
+    unsigned int begin = (unsigned int)((uint64_t)m_Count * worker / threads);
+    unsigned int end = (unsigned int)((uint64_t)m_Count * (worker + 1) / threads);
+    if (begin < end)
+        (*m_Record)(list, begin, end);
+}
+
+void CommandRecorder::Record(unsigned int count, const RecordFunction& record)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_JobMutex);
+        m_Record = &record;
+        m_Count = count;
+        m_JobsRemaining = (unsigned int)m_Workers.size();
+        m_JobGeneration++;
+    }
+    m_JobReady.notify_all();
+
+    RecordRange(0);
+
+    std::unique_lock<std::mutex> lock(m_JobMutex);
+    m_JobDone.wait(lock, [this] { return m_JobsRemaining == 0; });
+    m_Record = nullptr;
+}
+
+void CommandRecorder::WorkerLoop(unsigned int worker)
+{
+    uint64_t seenGeneration = 0;
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_JobMutex);
+            m_JobReady.wait(lock, [&] { return m_Quit || m_JobGeneration != seenGeneration; });
+            if (m_Quit)
+                return;
+            seenGeneration = m_JobGeneration;
+        }
+
+        RecordRange(worker);
+
+        std::lock_guard<std::mutex> lock(m_JobMutex);
+        if (--m_JobsRemaining == 0)
+            m_JobDone.notify_one();
+    }
+}
+
+unsigned int CommandRecorder::Execute() const
+{
+    return ExecuteCommandLists(m_ListPointers.data(), m_ListPointers.size());
+}
+
+unsigned int CommandRecorder::GetCommandCount() const
+{
+    unsigned int count = 0;
+    for (const CommandList& list : m_Lists)
+        count += list.GetCommandCount();
+    return count;
+}
+
+size_t CommandRecorder::GetSize() const
+{
+    size_t size = 0;
+    for (const CommandList& list : m_Lists)
+        size += list.GetSize();
+    return size;
+}
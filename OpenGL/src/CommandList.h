@@ -0,0 +1,179 @@
+#pragma once
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+//What a command does. The commands only hold plain numbers (object names,
+//locations, counts), nothing about the API that runs them, so recording
+//never touches a context.
+enum class CommandType : uint16_t
+{
+    BindProgram,
+    BindVertexArray,
+    BindTexture,
+    BindUniformRange,
+    SetUniform1i,
+    SetUniform4f,
+    DrawIndexed
+};
+
+struct BindProgramCommand { unsigned int Program; };
+struct BindVertexArrayCommand { unsigned int VertexArray; };
+//a 2D texture on unit Unit
+struct BindTextureCommand { unsigned int Unit; unsigned int Texture; };
+struct BindUniformRangeCommand { unsigned int Binding; unsigned int Buffer; unsigned int Offset; unsigned int Size; };
+//Location is in whatever program the list bound last
+struct SetUniform1iCommand { int Location; int Value; };
+struct SetUniform4fCommand { int Location; float Value[4]; };
+//GL_TRIANGLES with unsigned int indices from the bound VAO
+struct DrawIndexedCommand { unsigned int IndexCount; unsigned int FirstIndex; unsigned int InstanceCount; };
+
+//in front of every command's payload in the arena
+struct CommandHeader
+{
+    CommandType Type;
+    uint16_t Size; //header + payload, a multiple of 4
+};
+
+//One thread's stream of commands, packed back to back in a linear arena.
+//
+//Each command is a CommandHeader followed by its POD payload, appended into
+//64KB blocks that are kept across Reset(), so a list that's refilled every
+//frame stops allocating after the first one. A list is only ever written by
+//one thread; give each recording thread its own (CommandRecorder does) and
+//there is nothing to lock. Executing it is ExecuteCommandLists()'s job, on
+//the thread that owns the context.
+class CommandList
+{
+public:
+    static const size_t BlockSize = 64 * 1024;
+
+    CommandList() = default;
+    CommandList(const CommandList&) = delete;
+    CommandList& operator=(const CommandList&) = delete;
+    CommandList(CommandList&&) = default;
+    CommandList& operator=(CommandList&&) = default;
+
+    void BindProgram(unsigned int program) { Push(CommandType::BindProgram, BindProgramCommand{ program }); }
+    void BindVertexArray(unsigned int vertexArray) { Push(CommandType::BindVertexArray, BindVertexArrayCommand{ vertexArray }); }
+    void BindTexture(unsigned int unit, unsigned int texture) { Push(CommandType::BindTexture, BindTextureCommand{ unit, texture }); }
+    void BindUniformRange(unsigned int binding, unsigned int buffer, unsigned int offset, unsigned int size)
+    {
+        Push(CommandType::BindUniformRange, BindUniformRangeCommand{ binding, buffer, offset, size });
+    }
+    void SetUniform1i(int location, int value) { Push(CommandType::SetUniform1i, SetUniform1iCommand{ location, value }); }
+    void SetUniform4f(int location, float x, float y, float z, float w)
+    {
+        Push(CommandType::SetUniform4f, SetUniform4fCommand{ location, { x, y, z, w } });
+    }
+    void DrawIndexed(unsigned int indexCount, unsigned int firstIndex = 0, unsigned int instanceCount = 1)
+    {
+        Push(CommandType::DrawIndexed, DrawIndexedCommand{ indexCount, firstIndex, instanceCount });
+    }
+
+    //empties the list, the blocks stay allocated
+    void Reset();
+    unsigned int GetCommandCount() const { return m_CommandCount; }
+    //bytes of commands recorded since Reset()
+    size_t GetSize() const;
+
+    //calls visit(header, payload) for every command in recording order
+    template<typename Visitor>
+    void ForEach(Visitor&& visit) const
+    {
+        //blocks past the one being written are empty since the last Reset()
+        for (const Block& block : m_Blocks)
+        {
+            for (size_t offset = 0; offset < block.Used;)
+            {
+                const CommandHeader* header = (const CommandHeader*)(block.Data.get() + offset);
+                visit(*header, (const void*)(header + 1));
+                offset += header->Size;
+            }
+        }
+    }
+private:
+    struct Block
+    {
+        std::unique_ptr<unsigned char[]> Data;
+        size_t Used = 0;
+    };
+
+    template<typename Command>
+    void Push(CommandType type, const Command& command)
+    {
+        static_assert(std::is_trivially_copyable<Command>::value, "commands are copied as bytes");
+        static_assert(sizeof(Command) % 4 == 0, "a command's payload keeps the next header aligned");
+        unsigned char* memory = Allocate(sizeof(CommandHeader) + sizeof(Command));
+        CommandHeader header = { type, (uint16_t)(sizeof(CommandHeader) + sizeof(Command)) };
+        memcpy(memory, &header, sizeof(header));
+        memcpy(memory + sizeof(header), &command, sizeof(Command));
+        m_CommandCount++;
+    }
+    //the next size bytes of the current block, moving on to (or making) the next one if they don't fit
+    unsigned char* Allocate(size_t size);
+
+    std::vector<Block> m_Blocks;
+    size_t m_Block = 0; //the block being written
+    unsigned int m_CommandCount = 0;
+};
+
+//Runs lists in the order given, each in its recording order, through
+//GLStateCache, and the uniforms through the bound program's UniformState.
+//The GL backend for CommandList: call it on the thread that owns the context.
+//Returns how many draws it made
+unsigned int ExecuteCommandLists(const CommandList* const* lists, size_t count);
+
+//A pool that records one CommandList per thread, then hands them to the GL thread.
+//
+//Record(count, record) splits items 0..count into one contiguous range per
+//thread and calls record(list, begin, end) on each, the calling thread doing
+//the first range. Execute() then runs the lists in range order, so the
+//result is the same draws in the same order a single thread would have
+//recorded, whatever the thread count. The workers wait on a condition
+//variable between frames like SoftwareRasterizer's.
+class CommandRecorder
+{
+public:
+    using RecordFunction = std::function<void(CommandList& list, unsigned int begin, unsigned int end)>;
+
+    //threadCount of 0 means one per hardware thread
+    explicit CommandRecorder(unsigned int threadCount = 0);
+    ~CommandRecorder();
+
+    CommandRecorder(const CommandRecorder&) = delete;
+    CommandRecorder& operator=(const CommandRecorder&) = delete;
+
+    //resets every list, then records into them in parallel and returns when all are done
+    void Record(unsigned int count, const RecordFunction& record);
+    //needs the context, returns the draw count
+    unsigned int Execute() const;
+
+    unsigned int GetThreadCount() const { return (unsigned int)m_Workers.size() + 1; }
+    unsigned int GetCommandCount() const;
+    size_t GetSize() const;
+private:
+    void WorkerLoop(unsigned int worker);
+    void RecordRange(unsigned int worker);
+
+    std::vector<CommandList> m_Lists; //one per thread, the caller's first
+    std::vector<const CommandList*> m_ListPointers;
+
+    const RecordFunction* m_Record = nullptr;
+    unsigned int m_Count = 0;
+
+    std::vector<std::thread> m_Workers;
+    std::mutex m_JobMutex;
+    std::condition_variable m_JobReady;
+    std::condition_variable m_JobDone;
+    uint64_t m_JobGeneration = 0;
+    unsigned int m_JobsRemaining = 0;
+    bool m_Quit = false;
+};
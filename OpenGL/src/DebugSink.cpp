@@ -0,0 +1,241 @@
+#include "DebugSink.h"
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+
+static void FormatRecord(std::string& out, const DebugRecord& record);
+
+DebugSink& DebugSink::Get()
+{
+    static DebugSink sink;
+    return sink;
+}
+
+//covers early returns from main() that never reach Stop()
+DebugSink::~DebugSink()
+{
+    Stop();
+}
+
+void DebugSink::Start()
+{
+    if (IsRunning())
+        return;
+    m_Running.store(true, std::memory_order_release);
+    m_Thread = std::thread(&DebugSink::Run, this);
+}
+
+void DebugSink::Stop()
+{
+    if (!IsRunning())
+        return;
+    m_Running.store(false, std::memory_order_seq_cst);
+    m_Thread.join();
+
+    //a Push() that saw the sink running can still be copying its record after the
+    //thread's last drain. Wait for those, then this thread is the consumer.
+    while (m_Pushing.load(std::memory_order_seq_cst))
+        std::this_thread::yield();
+    DebugRecord record;
+    std::string out;
+    while (m_Records.TryPop(record))
+        FormatRecord(out, record);
+    if (!out.empty())
+    {
+        std::cout << out;
+        std::cout.flush();
+    }
+}
+
+bool DebugSink::Push(unsigned int id, GLenum source, GLenum type, GLenum severity,
+    const char* function, const char* file, int line, const char* message, int length)
+{
+    //counted before the flag is read, so Stop() either sees this push or we see it stopped
+    m_Pushing.fetch_add(1, std::memory_order_seq_cst);
+    if (!m_Running.load(std::memory_order_seq_cst))
+    {
+        m_Pushing.fetch_sub(1, std::memory_order_release);
+        return false;
+    }
+
+    DebugRecord record;
+    record.Id = id;
+    record.Source = source;
+    record.Type = type;
+    record.Severity = severity;
+    record.Function = function;
+    record.File = file;
+    record.Line = line;
+    size_t size = length < 0 ? strlen(message) : (size_t)length;
+    if (size >= sizeof(record.Message))
+        size = sizeof(record.Message) - 1;
+    memcpy(record.Message, message, size);
+    record.Message[size] = '\0';
+
+    if (m_Records.TryPush(record))
+        m_Pushed.fetch_add(1, std::memory_order_release);
+    else
+        m_Dropped.fetch_add(1, std::memory_order_relaxed);
+    m_Pushing.fetch_sub(1, std::memory_order_release);
+    return true;
+}
+
+void DebugSink::Flush()
+{
+    if (!IsRunning())
+        return;
+    uint64_t target = m_Pushed.load(std::memory_order_acquire);
+    //bounded, a stuck console shouldn't turn into a hang
+    for (int i = 0; i < 500 && m_Written.load(std::memory_order_acquire) < target; i++)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+}
+
+static const char* SourceName(GLenum source)
+{
+    switch (source)
+    {
+    case GL_DEBUG_SOURCE_API:             return "API";
+    case GL_DEBUG_SOURCE_WINDOW_SYSTEM:   return "Window System";
+    case GL_DEBUG_SOURCE_SHADER_COMPILER: return "Shader Compiler";
+    case GL_DEBUG_SOURCE_THIRD_PARTY:     return "Third Party";
+    case GL_DEBUG_SOURCE_APPLICATION:     return "Application";
+    default:                              return "Other";
+    }
+}
+
+static const char* TypeName(GLenum type)
+{
+    switch (type)
+    {
+    case GL_DEBUG_TYPE_ERROR:               return "Error";
+    case GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR: return "Deprecated";
+    case GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR:  return "Undefined Behavior";
+    case GL_DEBUG_TYPE_PORTABILITY:         return "Portability";
+    case GL_DEBUG_TYPE_PERFORMANCE:         return "Performance";
+    default:                                return "Other";
+    }
+}
+
+static const char* SeverityName(GLenum severity)
+{
+    switch (severity)
+    {
+    case GL_DEBUG_SEVERITY_HIGH:   return "high";
+    case GL_DEBUG_SEVERITY_MEDIUM: return "medium";
+    case GL_DEBUG_SEVERITY_LOW:    return "low";
+    default:                       return "notification";
+    }
+}
+
+//the same message from the same call site counts as a repeat
+static uint64_t RecordKey(const DebugRecord& record)
+{
+    uint64_t key = 14695981039346656037ull;
+    auto mix = [&key](uint64_t value) { key = (key ^ value) * 1099511628211ull; };
+    mix(record.Id);
+    mix(record.Source);
+    mix(record.Type);
+    mix((uint64_t)(uintptr_t)record.File);
+    mix((uint64_t)record.Line);
+    return key;
+}
+
+static void FormatRecord(std::string& out, const DebugRecord& record)
+{
+    out += "[OpenGL ";
+    out += TypeName(record.Type);
+    out += "] (";
+    out += std::to_string(record.Id);
+    out += ") ";
+    out += SourceName(record.Source);
+    out += ", ";
+    out += SeverityName(record.Severity);
+    out += ": ";
+    out += record.Message;
+    out += '\n';
+    if (record.File)
+    {
+        out += "    ";
+        out += record.Function;
+        out += " ";
+        out += record.File;
+        out += ":";
+        out += std::to_string(record.Line);
+        out += '\n';
+    }
+}
+
+void DebugSink::Run()
+{
+    struct Seen
+    {
+        DebugRecord First;
+        uint64_t Count = 0;
+        uint64_t Reported = 0;
+    };
+    std::unordered_map<uint64_t, Seen> seen;
+    std::string out;
+    auto lastSummary = std::chrono::steady_clock::now();
+
+    auto summarizeRepeats = [&]() {
+        for (auto& entry : seen)
+        {
+            Seen& message = entry.second;
+            if (message.Count == message.Reported)
+                continue;
+            out += "[OpenGL] (" + std::to_string(message.First.Id) + ") repeated "
+                + std::to_string(message.Count - message.Reported) + " more times";
+            if (message.First.File)
+                out += std::string(" at ") + message.First.File + ":" + std::to_string(message.First.Line);
+            out += '\n';
+            message.Reported = message.Count;
+        }
+    };
+
+    while (true)
+    {
+        //read the flag before draining, so nothing pushed before Stop() is missed
+        bool running = IsRunning();
+
+        DebugRecord record;
+        uint64_t drained = 0;
+        while (m_Records.TryPop(record))
+        {
+            drained++;
+            Seen& message = seen[RecordKey(record)];
+            if (message.Count++ == 0)
+            {
+                message.First = record;
+                message.Reported = 1;
+                FormatRecord(out, record);
+            }
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        if (!running || now - lastSummary > std::chrono::seconds(1))
+        {
+            summarizeRepeats();
+            lastSummary = now;
+        }
+        if (!running && m_Dropped.load(std::memory_order_relaxed))
+            out += "[OpenGL] " + std::to_string(m_Dropped.load(std::memory_order_relaxed)) + " messages dropped, the sink fell behind\n";
+
+        //one write and one flush per batch instead of one per line
+        if (!out.empty())
+        {
+            std::cout << out;
+            std::cout.flush();
+            out.clear();
+        }
+        if (drained)
+            m_Written.fetch_add(drained, std::memory_order_release);
+
+        if (!running)
+            return;
+        if (!drained)
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+}
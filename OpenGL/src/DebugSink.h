@@ -0,0 +1,124 @@
+#pragma once
+#include <GL/glew.h>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+
+//Bounded lock-free queue for many producers and a single consumer
+//(Dmitry Vyukov's bounded MPMC queue with the consumer side simplified).
+//Every cell carries a sequence number, so producers only contend on one
+//compare-exchange of the write index and never wait on the consumer.
+//Capacity must be a power of two.
+template<typename T, size_t Capacity>
+class MPSCRingBuffer
+{
+    static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+public:
+    MPSCRingBuffer()
+    {
+        for (size_t i = 0; i < Capacity; i++)
+            m_Cells[i].Sequence.store(i, std::memory_order_relaxed);
+    }
+
+    //any thread, returns false instead of blocking when the buffer is full
+    bool TryPush(const T& value)
+    {
+        Cell* cell;
+        size_t pos = m_WritePos.load(std::memory_order_relaxed);
+        while (true)
+        {
+            cell = &m_Cells[pos & (Capacity - 1)];
+            size_t sequence = cell->Sequence.load(std::memory_order_acquire);
+            intptr_t diff = (intptr_t)sequence - (intptr_t)pos;
+            if (diff == 0)
+            {
+                if (m_WritePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            }
+            else if (diff < 0)
+                return false;
+            else
+                pos = m_WritePos.load(std::memory_order_relaxed);
+        }
+        cell->Value = value;
+        cell->Sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    //consumer thread only
+    bool TryPop(T& value)
+    {
+        Cell& cell = m_Cells[m_ReadPos & (Capacity - 1)];
+        size_t sequence = cell.Sequence.load(std::memory_order_acquire);
+        if (sequence != m_ReadPos + 1)
+            return false;
+        value = cell.Value;
+        cell.Sequence.store(m_ReadPos + Capacity, std::memory_order_release);
+        m_ReadPos++;
+        return true;
+    }
+private:
+    struct Cell
+    {
+        std::atomic<size_t> Sequence;
+        T Value;
+    };
+
+    Cell m_Cells[Capacity];
+    alignas(64) std::atomic<size_t> m_WritePos{ 0 };
+    alignas(64) size_t m_ReadPos = 0;
+};
+
+//One GL error or KHR_debug message, small enough to copy into the ring buffer
+//without allocating. Function/File are the GLCall's string literals.
+struct DebugRecord
+{
+    unsigned int Id;
+    GLenum Source;
+    GLenum Type;
+    GLenum Severity;
+    const char* Function;
+    const char* File;
+    int Line;
+    char Message[128]; //truncated driver text
+};
+
+//Takes GL errors and KHR_debug messages off the render thread.
+//Push() only copies a record into the ring buffer. A background thread
+//formats them, writes each distinct message (same id, source and call site)
+//once, and after that only prints how many more times it happened, so a
+//frame that spams the same error can't stall rendering on console output.
+class DebugSink
+{
+public:
+    static DebugSink& Get();
+    ~DebugSink();
+
+    void Start();
+    //drains everything still queued and prints the repeat counts
+    void Stop();
+    bool IsRunning() const { return m_Running.load(std::memory_order_acquire); }
+
+    //lock-free, never blocks. When the buffer is full the record is dropped and counted.
+    //Returns false only if the sink isn't running, then the caller should print it itself.
+    bool Push(unsigned int id, GLenum source, GLenum type, GLenum severity,
+        const char* function, const char* file, int line, const char* message, int length = -1);
+
+    //waits until everything pushed so far has been written out.
+    //Only for right before an ASSERT fires, so the message isn't lost with the process.
+    void Flush();
+
+    uint64_t GetDroppedCount() const { return m_Dropped.load(std::memory_order_relaxed); }
+private:
+    DebugSink() = default;
+    void Run();
+
+    MPSCRingBuffer<DebugRecord, 1024> m_Records;
+    std::atomic<bool> m_Running{ false };
+    std::atomic<uint64_t> m_Dropped{ 0 };
+    std::atomic<uint64_t> m_Pushed{ 0 };
+    std::atomic<uint64_t> m_Written{ 0 };
+    std::atomic<unsigned int> m_Pushing{ 0 }; //Push() calls between the running check and the copy
+    std::thread m_Thread;
+};
@@ -0,0 +1,100 @@
+#include "DrawBucket.h"
+#include "GLStateCache.h"
+#include "Renderer.h"
+
+#include <chrono>
+#include <utility>
+
+void DrawBucket::Reserve(unsigned int draws)
+{
+    m_Entries.reserve(draws);
+    m_Scratch.reserve(draws);
+    m_Commands.reserve(draws);
+}
+
+void DrawBucket::Submit(uint64_t key, const DrawCommand& command)
+{
+    m_Entries.push_back({ key, (unsigned int)m_Commands.size() });
+    m_Commands.push_back(command);
+    m_Sorted = false;
+}
+
+void DrawBucket::Sort()
+{
+    if (m_Sorted || m_Entries.empty())
+        return;
+    auto start = std::chrono::steady_clock::now();
+
+    size_t count = m_Entries.size();
+    m_Scratch.resize(count);
+    //lowest byte first, each pass is stable so the higher bytes end up deciding
+    for (unsigned int shift = 0; shift < 64; shift += 8)
+    {
+        size_t offsets[256] = {};
+        for (const Entry& entry : m_Entries)
+            offsets[(entry.Key >> shift) & 0xff]++;
+        //all in one bucket, this byte wouldn't move anything
+        if (offsets[(m_Entries[0].Key >> shift) & 0xff] == count)
+            continue;
+
+        size_t sum = 0;
+        for (size_t& offset : offsets)
+        {
+            size_t bucketSize = offset;
+            offset = sum;
+            sum += bucketSize;
+        }
+        for (const Entry& entry : m_Entries)
+            m_Scratch[offsets[(entry.Key >> shift) & 0xff]++] = entry;
+        std::swap(m_Entries, m_Scratch);
+    }
+
+    m_SortMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    m_Sorted = true;
+}
+
+void DrawBucket::Flush(bool sort)
+{
+    m_Stats = Stats();
+    if (m_Commands.empty())
+        return;
+    if (sort)
+    {
+        Sort();
+        m_Stats.SortMs = m_SortMs;
+    }
+
+    GLStateCache& state = GLStateCache::Get();
+    const DrawCommand* previous = nullptr;
+    for (const Entry& entry : m_Entries)
+    {
+        const DrawCommand& command = m_Commands[entry.Command];
+        if (!previous || previous->Program != command.Program)
+            m_Stats.ProgramChanges++;
+        if (!previous || previous->VertexArray != command.VertexArray)
+            m_Stats.VertexArrayChanges++;
+        if (command.Texture && (!previous || previous->Texture != command.Texture))
+            m_Stats.TextureChanges++;
+        previous = &command;
+
+        state.UseProgram(command.Program);
+        state.BindVertexArray(command.VertexArray);
+        if (command.Texture)
+            state.BindTexture(0, GL_TEXTURE_2D, command.Texture);
+        const void* indices = (const void*)(size_t)(command.FirstIndex * sizeof(unsigned int));
+        if (command.InstanceCount == 1)
+        {
+            GLCall(glDrawElements(GL_TRIANGLES, command.IndexCount, GL_UNSIGNED_INT, indices));
+        }
+        else
+        {
+            GLCall(glDrawElementsInstanced(GL_TRIANGLES, command.IndexCount, GL_UNSIGNED_INT, indices, command.InstanceCount));
+        }
+    }
+    m_Stats.Draws = (unsigned int)m_Entries.size();
+
+    m_Entries.clear();
+    m_Commands.clear();
+    m_Sorted = true;
+    m_SortMs = 0.0;
+}
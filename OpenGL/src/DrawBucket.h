@@ -0,0 +1,87 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+//Bits of a draw key, most significant first. Sorting by the key groups draws
+//by layer, then program, then material, then VAO, so each of those changes as
+//rarely as it can, and draws with identical state go front to back.
+//Names wider than their field wrap; that only costs sort order, never correctness,
+//since the command carries the real names.
+constexpr unsigned int DrawKeyLayerBits = 4;
+constexpr unsigned int DrawKeyProgramBits = 12;
+constexpr unsigned int DrawKeyMaterialBits = 16;
+constexpr unsigned int DrawKeyVertexArrayBits = 12;
+constexpr unsigned int DrawKeyDepthBits = 20;
+static_assert(DrawKeyLayerBits + DrawKeyProgramBits + DrawKeyMaterialBits + DrawKeyVertexArrayBits + DrawKeyDepthBits == 64,
+    "a draw key is 64 bits");
+
+//depth is 0 (near) to 1 (far), pass 1 - depth to draw a layer back to front
+constexpr uint64_t MakeDrawKey(unsigned int layer, unsigned int program, unsigned int material,
+    unsigned int vertexArray, float depth)
+{
+    float clamped = depth < 0.0f ? 0.0f : depth > 1.0f ? 1.0f : depth;
+    uint64_t key = layer & ((1u << DrawKeyLayerBits) - 1);
+    key = key << DrawKeyProgramBits | (program & ((1u << DrawKeyProgramBits) - 1));
+    key = key << DrawKeyMaterialBits | (material & ((1u << DrawKeyMaterialBits) - 1));
+    key = key << DrawKeyVertexArrayBits | (vertexArray & ((1u << DrawKeyVertexArrayBits) - 1));
+    key = key << DrawKeyDepthBits | (uint64_t)(clamped * ((1u << DrawKeyDepthBits) - 1));
+    return key;
+}
+
+//One indexed draw and the state it needs
+struct DrawCommand
+{
+    unsigned int Program = 0;
+    unsigned int VertexArray = 0;
+    unsigned int Texture = 0;  //GL_TEXTURE_2D on unit 0, 0 leaves unit 0 alone
+    unsigned int IndexCount = 0;
+    unsigned int FirstIndex = 0;
+    unsigned int InstanceCount = 1;
+};
+
+//A frame's draws, replayed in key order instead of submission order.
+//
+//Submit() only appends the command and its key. Flush() sorts the keys with
+//an 8 pass LSD radix sort (a pass is skipped when every key has the same
+//byte there, which is most of them when only a few programs and layers are
+//in use), then binds and draws each command through GLStateCache, so state
+//that doesn't change between neighbours isn't set again. Draws with equal
+//keys keep their submission order. Main thread only.
+class DrawBucket
+{
+public:
+    //counted by Flush(), between one command and the next
+    struct Stats
+    {
+        unsigned int Draws = 0;
+        unsigned int ProgramChanges = 0;
+        unsigned int VertexArrayChanges = 0;
+        unsigned int TextureChanges = 0;
+        double SortMs = 0.0;
+    };
+
+    void Reserve(unsigned int draws);
+    void Submit(uint64_t key, const DrawCommand& command);
+    unsigned int GetCount() const { return (unsigned int)m_Commands.size(); }
+
+    //sorts the submitted draws by key, Flush() does it too
+    void Sort();
+    //draws everything submitted since the last Flush(), sorted unless sort is false
+    //(to compare against submission order), and empties the bucket
+    void Flush(bool sort = true);
+    //the last Flush()
+    const Stats& GetStats() const { return m_Stats; }
+private:
+    struct Entry
+    {
+        uint64_t Key;
+        unsigned int Command; //index into m_Commands
+    };
+
+    std::vector<Entry> m_Entries;
+    std::vector<Entry> m_Scratch; //the other half of each radix pass
+    std::vector<DrawCommand> m_Commands;
+    bool m_Sorted = true;
+    double m_SortMs = 0.0; //the last Sort() of what's in the bucket now
+    Stats m_Stats;
+};
@@ -0,0 +1,116 @@
+#include "FileWatcher.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <iostream>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+FileWatcher::~FileWatcher()
+{
+    Stop();
+}
+
+bool FileWatcher::Start()
+{
+#ifdef __linux__
+    if (m_Running)
+        return true;
+    m_Fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (m_Fd < 0)
+    {
+        std::cout << "[FileWatcher] inotify_init1 failed" << std::endl;
+        return false;
+    }
+    m_Running = true;
+    m_Thread = std::thread(&FileWatcher::Run, this);
+    return true;
+#else
+    std::cout << "[FileWatcher] File watching is only implemented on Linux" << std::endl;
+    return false;
+#endif
+}
+
+void FileWatcher::Stop()
+{
+    if (!m_Running.exchange(false))
+        return;
+    m_Thread.join();
+#ifdef __linux__
+    close(m_Fd);
+#endif
+    m_Fd = -1;
+    m_Directories.clear();
+}
+
+void FileWatcher::Watch(const std::string& filepath)
+{
+#ifdef __linux__
+    if (m_Fd < 0)
+        return;
+    std::string directory = std::filesystem::path(filepath).parent_path().lexically_normal().generic_string();
+    if (directory.empty())
+        directory = ".";
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    for (auto& [wd, watched] : m_Directories)
+    {
+        if (watched == directory)
+            return;
+    }
+    //IN_CLOSE_WRITE for editors that write in place, IN_MOVED_TO for the ones that rename
+    int wd = inotify_add_watch(m_Fd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+    if (wd < 0)
+    {
+        std::cout << "[FileWatcher] Can't watch " << directory << std::endl;
+        return;
+    }
+    m_Directories[wd] = directory;
+#else
+    (void)filepath;
+#endif
+}
+
+std::vector<std::string> FileWatcher::TakeChanges()
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    std::vector<std::string> changes;
+    changes.swap(m_Changes);
+    return changes;
+}
+
+void FileWatcher::Run()
+{
+#ifdef __linux__
+    alignas(inotify_event) char buffer[4096];
+    pollfd descriptor = { m_Fd, POLLIN, 0 };
+    while (m_Running.load(std::memory_order_acquire))
+    {
+        //wake up now and then to see if Stop() was called
+        if (poll(&descriptor, 1, 100) <= 0)
+            continue;
+
+        ssize_t length;
+        while ((length = read(m_Fd, buffer, sizeof(buffer))) > 0)
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            for (char* c = buffer; c < buffer + length;)
+            {
+                const inotify_event* event = (const inotify_event*)c;
+                c += sizeof(inotify_event) + event->len;
+
+                auto directory = m_Directories.find(event->wd);
+                if (event->len == 0 || directory == m_Directories.end())
+                    continue;
+                std::string path = std::filesystem::path(directory->second + "/" + event->name).lexically_normal().generic_string();
+                if (std::find(m_Changes.begin(), m_Changes.end(), path) == m_Changes.end())
+                    m_Changes.push_back(std::move(path));
+            }
+        }
+    }
+#endif
+}
@@ -0,0 +1,43 @@
+#pragma once
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+//Reports files that were written, on a background thread.
+//
+//Linux only (inotify), elsewhere Start() returns false and nothing is reported.
+//Directories are watched rather than files, since most editors save by
+//writing a temporary file and renaming it over the original, which would
+//silently end a watch on the file itself.
+class FileWatcher
+{
+public:
+    FileWatcher() = default;
+    ~FileWatcher();
+
+    FileWatcher(const FileWatcher&) = delete;
+    FileWatcher& operator=(const FileWatcher&) = delete;
+
+    bool Start();
+    void Stop();
+
+    //starts watching the directory the file is in, any thread
+    void Watch(const std::string& filepath);
+
+    //paths (normalized like ShaderPreprocessor's) written since the last call,
+    //each listed once however many events it got
+    std::vector<std::string> TakeChanges();
+private:
+    void Run();
+
+    int m_Fd = -1;
+    std::atomic<bool> m_Running{ false };
+    std::thread m_Thread;
+
+    std::mutex m_Mutex;
+    std::unordered_map<int, std::string> m_Directories; //watch descriptor -> directory
+    std::vector<std::string> m_Changes;
+};
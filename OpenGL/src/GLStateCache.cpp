@@ -0,0 +1,236 @@
+#include "GLStateCache.h"
+#include "Renderer.h"
+
+#include <iostream>
+
+GLStateCache& GLStateCache::Get()
+{
+    static GLStateCache cache;
+    return cache;
+}
+
+int GLStateCache::BufferTargetIndex(GLenum target)
+{
+    switch (target)
+    {
+    case GL_ARRAY_BUFFER: return 0;
+    case GL_ELEMENT_ARRAY_BUFFER: return 1;
+    case GL_UNIFORM_BUFFER: return 2;
+    case GL_COPY_READ_BUFFER: return 3;
+    case GL_COPY_WRITE_BUFFER: return 4;
+    case GL_PIXEL_PACK_BUFFER: return 5;
+    case GL_PIXEL_UNPACK_BUFFER: return 6;
+    case GL_DRAW_INDIRECT_BUFFER: return 7;
+    }
+    return -1;
+}
+
+int GLStateCache::TextureTargetIndex(GLenum target)
+{
+    switch (target)
+    {
+    case GL_TEXTURE_2D: return 0;
+    case GL_TEXTURE_2D_ARRAY: return 1;
+    case GL_TEXTURE_3D: return 2;
+    case GL_TEXTURE_CUBE_MAP: return 3;
+    case GL_TEXTURE_1D: return 4;
+    }
+    return -1;
+}
+
+bool GLStateCache::Changed(unsigned int& mirror, unsigned int value)
+{
+    if (mirror == value)
+    {
+        m_Frame.Elided++;
+        return false;
+    }
+    mirror = value;
+    m_Frame.Issued++;
+    return true;
+}
+
+void GLStateCache::BindVertexArray(unsigned int vertexArray)
+{
+    if (!Changed(m_VertexArray, vertexArray))
+        return;
+    GLCall(glBindVertexArray(vertexArray));
+    m_Buffers[BufferTargetIndex(GL_ELEMENT_ARRAY_BUFFER)] = Unknown;
+}
+
+void GLStateCache::BindBuffer(GLenum target, unsigned int buffer)
+{
+    int index = BufferTargetIndex(target);
+    if (index < 0)
+        m_Frame.Issued++;
+    else if (!Changed(m_Buffers[index], buffer))
+        return;
+    GLCall(glBindBuffer(target, buffer));
+}
+
+void GLStateCache::BindBufferRange(GLenum target, unsigned int index, unsigned int buffer, GLintptr offset, GLsizeiptr size)
+{
+    int targetIndex = BufferTargetIndex(target);
+    if (target == GL_UNIFORM_BUFFER && index < UniformBindingCount)
+    {
+        BufferRange& range = m_UniformRanges[index];
+        //the generic binding has to match too, glBindBufferRange changes it
+        if (range.Buffer == buffer && range.Offset == offset && range.Size == size && m_Buffers[targetIndex] == buffer)
+        {
+            m_Frame.Elided++;
+            return;
+        }
+        range = { buffer, offset, size };
+    }
+    m_Frame.Issued++;
+    GLCall(glBindBufferRange(target, index, buffer, offset, size));
+    if (targetIndex >= 0)
+        m_Buffers[targetIndex] = buffer;
+}
+
+void GLStateCache::UseProgram(unsigned int program)
+{
+    if (Changed(m_Program, program))
+    {
+        GLCall(glUseProgram(program));
+    }
+}
+
+void GLStateCache::BindTexture(unsigned int unit, GLenum target, unsigned int texture)
+{
+    int index = TextureTargetIndex(target);
+    if (unit < TextureUnitCount && index >= 0)
+    {
+        if (m_Textures[unit][index] == texture)
+        {
+            m_Frame.Elided++;
+            return;
+        }
+        m_Textures[unit][index] = texture;
+    }
+    if (Changed(m_ActiveTexture, unit))
+    {
+        GLCall(glActiveTexture(GL_TEXTURE0 + unit));
+    }
+    m_Frame.Issued++;
+    GLCall(glBindTexture(target, texture));
+}
+
+void GLStateCache::SetBlend(bool enabled)
+{
+    if (!Changed(m_Blend, enabled))
+        return;
+    if (enabled)
+    {
+        GLCall(glEnable(GL_BLEND));
+    }
+    else
+    {
+        GLCall(glDisable(GL_BLEND));
+    }
+}
+
+void GLStateCache::SetBlendFunc(GLenum source, GLenum destination)
+{
+    if (m_BlendSource == source && m_BlendDestination == destination)
+    {
+        m_Frame.Elided++;
+        return;
+    }
+    m_BlendSource = source;
+    m_BlendDestination = destination;
+    m_Frame.Issued++;
+    GLCall(glBlendFunc(source, destination));
+}
+
+void GLStateCache::SetDepthTest(bool enabled)
+{
+    if (!Changed(m_DepthTest, enabled))
+        return;
+    if (enabled)
+    {
+        GLCall(glEnable(GL_DEPTH_TEST));
+    }
+    else
+    {
+        GLCall(glDisable(GL_DEPTH_TEST));
+    }
+}
+
+void GLStateCache::Invalidate()
+{
+    m_VertexArray = Unknown;
+    for (unsigned int& buffer : m_Buffers)
+        buffer = Unknown;
+    for (BufferRange& range : m_UniformRanges)
+        range = BufferRange();
+    m_Program = Unknown;
+    m_ActiveTexture = Unknown;
+    for (auto& unit : m_Textures)
+    {
+        for (unsigned int& texture : unit)
+            texture = Unknown;
+    }
+    m_Blend = Unknown;
+    m_BlendSource = Unknown;
+    m_BlendDestination = Unknown;
+    m_DepthTest = Unknown;
+}
+
+void GLStateCache::ForgetVertexArray(unsigned int vertexArray)
+{
+    //deleting the bound VAO binds 0, whose index buffer we don't know
+    if (vertexArray && m_VertexArray == vertexArray)
+    {
+        m_VertexArray = 0;
+        m_Buffers[BufferTargetIndex(GL_ELEMENT_ARRAY_BUFFER)] = Unknown;
+    }
+}
+
+void GLStateCache::ForgetBuffer(unsigned int buffer)
+{
+    if (!buffer)
+        return;
+    for (unsigned int& bound : m_Buffers)
+    {
+        if (bound == buffer)
+            bound = 0;
+    }
+    for (BufferRange& range : m_UniformRanges)
+    {
+        if (range.Buffer == buffer)
+            range = { 0, 0, 0 };
+    }
+}
+
+void GLStateCache::ForgetTexture(unsigned int texture)
+{
+    if (!texture)
+        return;
+    for (auto& unit : m_Textures)
+    {
+        for (unsigned int& bound : unit)
+        {
+            if (bound == texture)
+                bound = 0;
+        }
+    }
+}
+
+void GLStateCache::EndFrame()
+{
+    m_Total.Issued += m_Frame.Issued;
+    m_Total.Elided += m_Frame.Elided;
+    m_Frame = Counters();
+    m_Frames++;
+}
+
+void GLStateCache::PrintStats() const
+{
+    uint64_t total = m_Total.Issued + m_Total.Elided;
+    if (m_Frames == 0 || total == 0)
+        return;
+    std::cout << "[GLStateCache] " << (double)m_Total.Issued / m_Frames << " state calls issued, "
+        << (double)m_Total.Elided / m_Frames << " elided per frame over " << m_Frames << " frames";
+    std::cout << " (" << 100.0 * m_Total.Elided / total << "% elided)" << std::endl;
+}
@@ -0,0 +1,90 @@
+#pragma once
+#include <GL/glew.h>
+#include <cstdint>
+
+//Mirror of the GL binding state the app changes most, so a bind of what's
+//already bound never reaches the driver.
+//
+//Covers the bound VAO, the buffer bound to each common target, indexed
+//uniform buffer ranges, the current program, the 2D/3D/array/cube texture
+//bound to each unit and the blend and depth test switches. Everything starts
+//out unknown, so the first call of each kind is always issued.
+//
+//Only calls made through the cache are seen. Code that changes the same
+//state with raw GL has to put it back (like ShaderWarmup::Run does) or call
+//Invalidate(). Deleting a bound buffer, VAO or texture unbinds it, so the
+//owners call Forget*() before deleting. Main thread only, it mirrors the
+//one context the app draws with.
+class GLStateCache
+{
+public:
+    static GLStateCache& Get();
+
+    void BindVertexArray(unsigned int vertexArray);
+    //GL_ELEMENT_ARRAY_BUFFER is part of the bound VAO, binding a VAO makes it unknown again
+    void BindBuffer(GLenum target, unsigned int buffer);
+    //also binds the buffer to target like glBindBufferRange does
+    void BindBufferRange(GLenum target, unsigned int index, unsigned int buffer, GLintptr offset, GLsizeiptr size);
+    void UseProgram(unsigned int program);
+    //makes unit active (if it wasn't) and binds texture to target on it
+    void BindTexture(unsigned int unit, GLenum target, unsigned int texture);
+    void SetBlend(bool enabled);
+    void SetBlendFunc(GLenum source, GLenum destination);
+    void SetDepthTest(bool enabled);
+
+    //forget everything, the next call of each kind is issued
+    void Invalidate();
+    //call before glDelete*, GL unbinds a deleted object wherever it was bound
+    void ForgetVertexArray(unsigned int vertexArray);
+    void ForgetBuffer(unsigned int buffer);
+    void ForgetTexture(unsigned int texture);
+
+    //calls issued vs elided
+    struct Counters
+    {
+        uint64_t Issued = 0;
+        uint64_t Elided = 0;
+    };
+    Counters GetFrameCounters() const { return m_Frame; }
+    //call once a frame, moves this frame's counts into the run totals
+    void EndFrame();
+    //per frame averages and the share of calls that were elided, nothing if no call was made
+    void PrintStats() const;
+private:
+    GLStateCache() { Invalidate(); }
+
+    static const unsigned int Unknown = ~0u;
+    static const unsigned int BufferTargetCount = 8;
+    static const unsigned int UniformBindingCount = 16;
+    static const unsigned int TextureUnitCount = 16;
+    static const unsigned int TextureTargetCount = 5;
+
+    //index into the per target arrays, -1 for targets that aren't mirrored
+    static int BufferTargetIndex(GLenum target);
+    static int TextureTargetIndex(GLenum target);
+
+    //true (and counts it issued) when value differs from the mirror, which then takes value
+    bool Changed(unsigned int& mirror, unsigned int value);
+
+    struct BufferRange
+    {
+        unsigned int Buffer = Unknown;
+        GLintptr Offset = 0;
+        GLsizeiptr Size = 0;
+    };
+
+    unsigned int m_VertexArray;
+    unsigned int m_Buffers[BufferTargetCount];
+    BufferRange m_UniformRanges[UniformBindingCount];
+    unsigned int m_Program;
+    unsigned int m_ActiveTexture; //unit index, not GL_TEXTUREi
+    unsigned int m_Textures[TextureUnitCount][TextureTargetCount];
+    unsigned int m_Blend;         //0, 1 or Unknown
+    unsigned int m_BlendSource;
+    unsigned int m_BlendDestination;
+    unsigned int m_DepthTest;
+
+    Counters m_Frame;
+    Counters m_Total;
+    unsigned int m_Frames = 0;
+};
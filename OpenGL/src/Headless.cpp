@@ -0,0 +1,332 @@
+#include "Headless.h"
+#include "Renderer.h"
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+
+#ifdef __linux__
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+
+HeadlessContext::~HeadlessContext()
+{
+    Destroy();
+}
+
+#ifdef __linux__
+
+bool HeadlessContext::Create(int majorVersion, int minorVersion, const HeadlessContext* shareWith)
+{
+    EGLDisplay display = EGL_NO_DISPLAY;
+    if (shareWith)
+    {
+        display = shareWith->m_Display;
+        m_Shared = true;
+    }
+    else
+    {
+        //the surfaceless platform needs no display server at all,
+        //if the driver doesn't have it we try whatever the default display is
+        auto getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+        if (getPlatformDisplay)
+            display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+        if (display == EGL_NO_DISPLAY)
+            display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+
+        if (display == EGL_NO_DISPLAY || !eglInitialize(display, nullptr, nullptr))
+        {
+            std::cout << "[Headless] Failed to initialize an EGL display" << std::endl;
+            return false;
+        }
+    }
+    m_Display = display;
+
+    if (!eglBindAPI(EGL_OPENGL_API))
+    {
+        std::cout << "[Headless] EGL has no desktop OpenGL support" << std::endl;
+        Destroy();
+        return false;
+    }
+
+    const EGLint configAttribs[] = {
+        EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_RED_SIZE, 8, EGL_GREEN_SIZE, 8, EGL_BLUE_SIZE, 8, EGL_ALPHA_SIZE, 8,
+        EGL_NONE
+    };
+    EGLConfig config;
+    EGLint configCount = 0;
+    if (!eglChooseConfig(display, configAttribs, &config, 1, &configCount) || configCount == 0)
+    {
+        std::cout << "[Headless] No matching EGL config" << std::endl;
+        Destroy();
+        return false;
+    }
+
+    const EGLint contextAttribs[] = {
+        EGL_CONTEXT_MAJOR_VERSION, majorVersion,
+        EGL_CONTEXT_MINOR_VERSION, minorVersion,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+#if GL_ERROR_CHECK == GL_ERROR_CHECK_DEBUG_OUTPUT
+        EGL_CONTEXT_OPENGL_DEBUG, EGL_TRUE,
+#endif
+        EGL_NONE
+    };
+    EGLContext context = eglCreateContext(display, config, shareWith ? shareWith->m_Context : EGL_NO_CONTEXT, contextAttribs);
+    if (context == EGL_NO_CONTEXT)
+    {
+        std::cout << "[Headless] Failed to create a " << majorVersion << "." << minorVersion
+            << " core context" << std::endl;
+        Destroy();
+        return false;
+    }
+    m_Context = context;
+
+    //a shared context gets made current later by the thread that uses it,
+    //it only needs a pbuffer if the context it shares with needed one
+    if (m_Shared)
+    {
+        if (shareWith->m_Surface)
+        {
+            const EGLint pbufferAttribs[] = { EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE };
+            m_Surface = eglCreatePbufferSurface(display, config, pbufferAttribs);
+        }
+        return true;
+    }
+
+    //we render into an OffscreenTarget anyway, so only make a pbuffer
+    //when the driver can't make a context current without any surface
+    if (!eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context))
+    {
+        const EGLint pbufferAttribs[] = { EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE };
+        EGLSurface surface = eglCreatePbufferSurface(display, config, pbufferAttribs);
+        if (surface == EGL_NO_SURFACE || !eglMakeCurrent(display, surface, surface, context))
+        {
+            std::cout << "[Headless] Failed to make the EGL context current" << std::endl;
+            if (surface != EGL_NO_SURFACE)
+                eglDestroySurface(display, surface);
+            Destroy();
+            return false;
+        }
+        m_Surface = surface;
+    }
+    return true;
+}
+
+void HeadlessContext::Destroy()
+{
+    if (!m_Display)
+        return;
+    if (eglGetCurrentContext() == m_Context)
+        eglMakeCurrent(m_Display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    if (m_Surface)
+        eglDestroySurface(m_Display, m_Surface);
+    if (m_Context)
+        eglDestroyContext(m_Display, m_Context);
+    if (!m_Shared)
+        eglTerminate(m_Display);
+    m_Display = nullptr;
+    m_Context = nullptr;
+    m_Surface = nullptr;
+}
+
+void HeadlessContext::MakeCurrent() const
+{
+    EGLSurface surface = m_Surface ? m_Surface : EGL_NO_SURFACE;
+    eglMakeCurrent(m_Display, surface, surface, m_Context);
+}
+
+void HeadlessContext::DoneCurrent() const
+{
+    eglMakeCurrent(m_Display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+}
+
+bool HeadlessContext::IsValid() const
+{
+    return m_Context != nullptr;
+}
+
+#else
+
+bool HeadlessContext::Create(int majorVersion, int minorVersion, const HeadlessContext* shareWith)
+{
+    m_Shared = shareWith != nullptr;
+    if (!m_Shared && !glfwInit())
+        return false;
+
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, majorVersion);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, minorVersion);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+#if GL_ERROR_CHECK == GL_ERROR_CHECK_DEBUG_OUTPUT
+    glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, GLFW_TRUE);
+#endif
+    m_Window = glfwCreateWindow(1, 1, "Headless", NULL, shareWith ? shareWith->m_Window : NULL);
+    glfwDefaultWindowHints();
+    if (!m_Window)
+    {
+        std::cout << "[Headless] Failed to create a hidden window" << std::endl;
+        if (!m_Shared)
+            glfwTerminate();
+        return false;
+    }
+    //like the EGL path, a shared context is left for its own thread to make current
+    if (!m_Shared)
+        glfwMakeContextCurrent(m_Window);
+    return true;
+}
+
+void HeadlessContext::Destroy()
+{
+    if (!m_Window)
+        return;
+    glfwDestroyWindow(m_Window);
+    if (!m_Shared)
+        glfwTerminate();
+    m_Window = nullptr;
+}
+
+void HeadlessContext::MakeCurrent() const
+{
+    glfwMakeContextCurrent(m_Window);
+}
+
+void HeadlessContext::DoneCurrent() const
+{
+    glfwMakeContextCurrent(NULL);
+}
+
+bool HeadlessContext::IsValid() const
+{
+    return m_Window != nullptr;
+}
+
+#endif
+
+OffscreenTarget::~OffscreenTarget()
+{
+    Destroy();
+}
+
+bool OffscreenTarget::Create(int width, int height)
+{
+    m_Width = width;
+    m_Height = height;
+
+    glGenRenderbuffers(1, &m_ColorBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, m_ColorBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glGenFramebuffers(1, &m_Framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, m_Framebuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, m_ColorBuffer);
+    GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    if (status != GL_FRAMEBUFFER_COMPLETE)
+    {
+        std::cout << "[Headless] Framebuffer incomplete (" << status << ")" << std::endl;
+        Destroy();
+        return false;
+    }
+    return true;
+}
+
+void OffscreenTarget::Destroy()
+{
+    if (m_Framebuffer)
+        glDeleteFramebuffers(1, &m_Framebuffer);
+    if (m_ColorBuffer)
+        glDeleteRenderbuffers(1, &m_ColorBuffer);
+    m_Framebuffer = 0;
+    m_ColorBuffer = 0;
+}
+
+void OffscreenTarget::Bind() const
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, m_Framebuffer);
+    glViewport(0, 0, m_Width, m_Height);
+}
+
+void OffscreenTarget::Unbind() const
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void OffscreenTarget::ReadPixels(std::vector<unsigned char>& pixels) const
+{
+    pixels.resize((size_t)m_Width * m_Height * 4);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, m_Framebuffer);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, m_Width, m_Height, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+}
+
+static double NowMs()
+{
+    using namespace std::chrono;
+    return duration<double, std::milli>(steady_clock::now().time_since_epoch()).count();
+}
+
+void FrameTimer::BeginRun()
+{
+    m_FrameMs.clear();
+    m_RunStart = NowMs();
+    m_LastFrame = m_RunStart;
+    m_TotalMs = 0.0;
+}
+
+void FrameTimer::EndFrame()
+{
+    double now = NowMs();
+    m_FrameMs.push_back(now - m_LastFrame);
+    m_LastFrame = now;
+}
+
+void FrameTimer::EndRun()
+{
+    m_TotalMs = NowMs() - m_RunStart;
+}
+
+void FrameTimer::Print() const
+{
+    if (m_FrameMs.empty())
+    {
+        std::cout << "[FrameTimer] No frames rendered" << std::endl;
+        return;
+    }
+    std::vector<double> sorted = m_FrameMs;
+    std::sort(sorted.begin(), sorted.end());
+    size_t frames = sorted.size();
+    double p99 = sorted[std::min(frames - 1, frames * 99 / 100)];
+
+    std::cout << "[FrameTimer] " << frames << " frames in " << m_TotalMs << " ms\n"
+        << "  avg " << m_TotalMs / frames << " ms/frame (" << frames * 1000.0 / m_TotalMs << " fps)\n"
+        << "  min " << sorted.front() << " ms, median " << sorted[frames / 2]
+        << " ms, p99 " << p99 << " ms, max " << sorted.back() << " ms" << std::endl;
+}
+
+bool WriteImagePPM(const std::string& filepath, int width, int height, const std::vector<unsigned char>& pixels)
+{
+    std::ofstream stream(filepath, std::ios::binary);
+    if (!stream)
+    {
+        std::cout << "Failed to open " << filepath << " for writing" << std::endl;
+        return false;
+    }
+    stream << "P6\n" << width << " " << height << "\n255\n";
+    //PPM stores the top row first
+    for (int y = height - 1; y >= 0; y--)
+    {
+        const unsigned char* row = &pixels[(size_t)y * width * 4];
+        for (int x = 0; x < width; x++)
+            stream.write((const char*)&row[x * 4], 3);
+    }
+    return true;
+}
@@ -0,0 +1,91 @@
+#pragma once
+#include <string>
+#include <vector>
+
+struct GLFWwindow;
+
+//An OpenGL context that never shows a window.
+//On Linux this is an EGL context on Mesa's surfaceless platform, so it works
+//on build/benchmark boxes with no X or Wayland display (llvmpipe is fine).
+//Everywhere else we fall back to a hidden GLFW window.
+class HeadlessContext
+{
+public:
+    HeadlessContext() = default;
+    ~HeadlessContext();
+
+    HeadlessContext(const HeadlessContext&) = delete;
+    HeadlessContext& operator=(const HeadlessContext&) = delete;
+
+    //asks for a core profile context, the same version Basic.shader targets.
+    //With shareWith the new context shares buffers, shaders and programs with it,
+    //which is what ShaderCompiler's worker threads need.
+    bool Create(int majorVersion = 3, int minorVersion = 3, const HeadlessContext* shareWith = nullptr);
+    void Destroy();
+    void MakeCurrent() const;
+    //releases the context from the calling thread
+    void DoneCurrent() const;
+
+    bool IsValid() const;
+private:
+#ifdef __linux__
+    void* m_Display = nullptr; //EGLDisplay
+    void* m_Context = nullptr; //EGLContext
+    void* m_Surface = nullptr; //EGLSurface, only used when surfaceless contexts aren't supported
+#else
+    GLFWwindow* m_Window = nullptr;
+#endif
+    bool m_Shared = false; //shared contexts leave the display/library to the one they share with
+};
+
+//A framebuffer with a single RGBA8 color attachment.
+//With no default framebuffer to draw into, this is what glClear and
+//glDrawElements end up writing to in headless mode.
+class OffscreenTarget
+{
+public:
+    OffscreenTarget() = default;
+    ~OffscreenTarget();
+
+    OffscreenTarget(const OffscreenTarget&) = delete;
+    OffscreenTarget& operator=(const OffscreenTarget&) = delete;
+
+    bool Create(int width, int height);
+    void Destroy();
+
+    //binds the framebuffer and sets the viewport to cover it
+    void Bind() const;
+    void Unbind() const;
+
+    //reads the color attachment back, bottom row first like glReadPixels
+    void ReadPixels(std::vector<unsigned char>& pixels) const;
+
+    int GetWidth() const { return m_Width; }
+    int GetHeight() const { return m_Height; }
+private:
+    unsigned int m_Framebuffer = 0;
+    unsigned int m_ColorBuffer = 0;
+    int m_Width = 0;
+    int m_Height = 0;
+};
+
+//Collects per-frame wall clock times so headless runs can report throughput
+class FrameTimer
+{
+public:
+    void BeginRun();
+    void EndFrame();
+    //call after glFinish() so queued GPU work is part of the total
+    void EndRun();
+
+    void Print() const;
+private:
+    std::vector<double> m_FrameMs;
+    double m_RunStart = 0.0;
+    double m_LastFrame = 0.0;
+    double m_TotalMs = 0.0;
+};
+
+//Writes RGBA8 pixels (bottom row first, as glReadPixels returns them) to a binary PPM
+//so offscreen and software rendered frames can be viewed and diffed
+bool WriteImagePPM(const std::string& filepath, int width, int height, const std::vector<unsigned char>& pixels);
@@ -0,0 +1,56 @@
+#include "IndexBuffer.h"
+#include "GLStateCache.h"
+#include "Renderer.h"
+
+#include <utility>
+
+IndexBuffer::IndexBuffer(const unsigned int* data, unsigned int count, GLenum usage)
+    : m_Count(count)
+{
+    //GLuint is what the draw calls read, they had better be the same size
+    static_assert(sizeof(unsigned int) == sizeof(GLuint), "unsigned int isn't a GLuint");
+    GLCall(glGenBuffers(1, &m_RendererID));
+    GLStateCache::Get().BindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_RendererID);
+    GLCall(glBufferData(GL_ELEMENT_ARRAY_BUFFER, count * sizeof(unsigned int), data, usage));
+}
+
+IndexBuffer::~IndexBuffer()
+{
+    Reset();
+}
+
+IndexBuffer::IndexBuffer(IndexBuffer&& other) noexcept
+    : m_RendererID(std::exchange(other.m_RendererID, 0)), m_Count(std::exchange(other.m_Count, 0))
+{
+}
+
+IndexBuffer& IndexBuffer::operator=(IndexBuffer&& other) noexcept
+{
+    if (this != &other)
+    {
+        std::swap(m_RendererID, other.m_RendererID);
+        std::swap(m_Count, other.m_Count);
+    }
+    return *this;
+}
+
+void IndexBuffer::Bind() const
+{
+    GLStateCache::Get().BindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_RendererID);
+}
+
+void IndexBuffer::Unbind() const
+{
+    GLStateCache::Get().BindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+}
+
+void IndexBuffer::Reset()
+{
+    if (m_RendererID)
+    {
+        GLStateCache::Get().ForgetBuffer(m_RendererID);
+        GLCall(glDeleteBuffers(1, &m_RendererID));
+    }
+    m_RendererID = 0;
+    m_Count = 0;
+}
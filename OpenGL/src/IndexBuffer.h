@@ -0,0 +1,30 @@
+#pragma once
+#include <GL/glew.h>
+
+//Owns one GL buffer of unsigned int indices. Move-only, same rules as VertexBuffer.
+//The element array binding is part of a VAO's state, so a VertexArray that
+//was given this buffer binds it along with itself. That also means creating
+//one changes the index buffer of whichever VAO is bound at the time.
+class IndexBuffer
+{
+public:
+    IndexBuffer() = default;
+    IndexBuffer(const unsigned int* data, unsigned int count, GLenum usage = GL_STATIC_DRAW);
+    ~IndexBuffer();
+
+    IndexBuffer(const IndexBuffer&) = delete;
+    IndexBuffer& operator=(const IndexBuffer&) = delete;
+    IndexBuffer(IndexBuffer&& other) noexcept;
+    IndexBuffer& operator=(IndexBuffer&& other) noexcept;
+
+    void Bind() const;
+    void Unbind() const;
+    //see VertexBuffer::Reset()
+    void Reset();
+
+    unsigned int GetRendererID() const { return m_RendererID; }
+    unsigned int GetCount() const { return m_Count; }
+private:
+    unsigned int m_RendererID = 0;
+    unsigned int m_Count = 0;
+};
@@ -0,0 +1,41 @@
+#include "InstanceBuffer.h"
+#include "Renderer.h"
+#include "VertexArray.h"
+
+#include <cstring>
+
+InstanceBuffer::InstanceBuffer(unsigned int capacity)
+    : m_Buffer(nullptr, capacity, GL_STREAM_DRAW)
+{
+    m_Staging.reserve(capacity);
+}
+
+void InstanceBuffer::Push(const void* data, unsigned int size)
+{
+    //every instance is the same struct, the stride is whatever came first
+    ASSERT(m_Stride == 0 || m_Stride == size);
+    ASSERT(m_Staging.size() + size <= m_Buffer.GetSize());
+    m_Stride = size;
+    size_t offset = m_Staging.size();
+    m_Staging.resize(offset + size);
+    memcpy(&m_Staging[offset], data, size);
+}
+
+void InstanceBuffer::Upload()
+{
+    m_Count = m_Stride ? (unsigned int)(m_Staging.size() / m_Stride) : 0;
+    if (m_Staging.empty())
+        return;
+    //a fresh store, last frame's instanced draw may still be reading the old one
+    m_Buffer.Orphan();
+    m_Buffer.Upload(m_Staging.data(), (unsigned int)m_Staging.size());
+    m_Staging.clear();
+}
+
+void DrawElementsInstanced(const VertexArray& va, unsigned int indexCount, unsigned int instanceCount)
+{
+    if (instanceCount == 0)
+        return;
+    va.Bind();
+    GLCall(glDrawElementsInstanced(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, nullptr, instanceCount));
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include "VertexBuffer.h"
+#include <vector>
+
+class VertexArray;
+
+//Per-instance data for glDrawElementsInstanced, in its own vertex buffer.
+//
+//Push() one struct per instance into a CPU array, Upload() once a frame,
+//then one DrawElementsInstanced() draws the mesh that many times. The
+//attributes come from a VertexLayout added with a divisor of 1, so each is
+//read once per instance instead of once per vertex:
+//  struct QuadInstance { float Offset[2]; uint8_t Color[4]; using Layout = VertexLayout<Float2, UByte4Norm>; };
+//  va.AddBuffer(instances.GetBuffer(), QuadInstance::Layout(), 1, 1, 1);
+//Changing one instance's color or offset is then a few bytes in this buffer
+//rather than a uniform update and a draw call of its own.
+class InstanceBuffer
+{
+public:
+    InstanceBuffer() = default;
+    //capacity in bytes, needs a current context
+    explicit InstanceBuffer(unsigned int capacity);
+
+    template<typename Instance>
+    void Push(const Instance& instance)
+    {
+        static_assert(sizeof(Instance) == Instance::Layout::Stride, "push a struct whose Layout covers all of it");
+        Push(&instance, (unsigned int)sizeof(Instance));
+    }
+    void Push(const void* data, unsigned int size);
+
+    //orphans the buffer and uploads everything pushed since the last Upload()
+    void Upload();
+    //how many instances the last Upload() sent
+    unsigned int GetCount() const { return m_Count; }
+
+    VertexBuffer& GetBuffer() { return m_Buffer; }
+    void Reset() { m_Buffer.Reset(); }
+private:
+    VertexBuffer m_Buffer;
+    std::vector<unsigned char> m_Staging;
+    unsigned int m_Stride = 0;
+    unsigned int m_Count = 0;
+};
+
+//glDrawElementsInstanced with va's index buffer, indexCount unsigned int indices
+void DrawElementsInstanced(const VertexArray& va, unsigned int indexCount, unsigned int instanceCount);
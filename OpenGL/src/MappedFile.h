@@ -0,0 +1,33 @@
+#pragma once
+#include <string>
+#include <string_view>
+
+//A read-only memory mapping of a whole file.
+//The contents are paged in by the OS on first touch, nothing is copied,
+//so views into GetData() stay valid for as long as the MappedFile lives.
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    explicit MappedFile(const std::string& filepath) { Open(filepath); }
+    ~MappedFile();
+
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool Open(const std::string& filepath);
+    void Close();
+
+    bool IsOpen() const { return m_Open; }
+    std::string_view GetData() const { return std::string_view(m_Data, m_Size); }
+private:
+    const char* m_Data = nullptr;
+    size_t m_Size = 0;
+    bool m_Open = false; //an empty file is open but has nothing mapped
+#ifdef _WIN32
+    void* m_File = nullptr;
+    void* m_Mapping = nullptr;
+#endif
+};
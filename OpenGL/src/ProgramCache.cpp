@@ -0,0 +1,187 @@
+#include "ProgramCache.h"
+#include "Renderer.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+//bump when the entry layout changes, old entries then just miss
+static const uint32_t s_CacheVersion = 1;
+
+struct ProgramBinaryHeader
+{
+    char Magic[4];
+    uint32_t Version;
+    uint64_t Key;
+    uint32_t Format;
+    uint32_t Length;
+    double CompileMs;
+};
+
+static uint64_t HashBytes(uint64_t hash, const char* data, size_t size)
+{
+    //FNV-1a, plenty for telling sources apart
+    for (size_t i = 0; i < size; i++)
+        hash = (hash ^ (unsigned char)data[i]) * 1099511628211ull;
+    return hash;
+}
+
+static double MsSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+ProgramBinaryCache& ProgramBinaryCache::Get()
+{
+    static ProgramBinaryCache cache;
+    return cache;
+}
+
+bool ProgramBinaryCache::Open(const std::string& directory)
+{
+    int formats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    if (formats == 0)
+    {
+        std::cout << "[ProgramCache] Driver has no program binary formats, cache disabled" << std::endl;
+        return false;
+    }
+
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+    if (error)
+    {
+        std::cout << "[ProgramCache] Can't create " << directory << ": " << error.message() << std::endl;
+        return false;
+    }
+
+    m_Directory = directory;
+    m_DriverId = std::string((const char*)glGetString(GL_VENDOR)) + '\n'
+        + (const char*)glGetString(GL_RENDERER) + '\n'
+        + (const char*)glGetString(GL_VERSION);
+    m_Open = true;
+    return true;
+}
+
+uint64_t ProgramBinaryCache::Key(std::string_view vertexSource, std::string_view fragmentSource) const
+{
+    uint64_t hash = 14695981039346656037ull;
+    //the separators keep "ab"+"c" and "a"+"bc" from hashing the same
+    hash = HashBytes(hash, vertexSource.data(), vertexSource.size());
+    hash = HashBytes(hash, "", 1);
+    hash = HashBytes(hash, fragmentSource.data(), fragmentSource.size());
+    hash = HashBytes(hash, "", 1);
+    hash = HashBytes(hash, m_DriverId.c_str(), m_DriverId.size());
+    return hash;
+}
+
+std::string ProgramBinaryCache::EntryPath(uint64_t key) const
+{
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.bin", (unsigned long long)key);
+    return m_Directory + "/" + name;
+}
+
+unsigned int ProgramBinaryCache::Load(std::string_view vertexSource, std::string_view fragmentSource)
+{
+    if (!m_Open)
+        return 0;
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    auto start = std::chrono::steady_clock::now();
+    uint64_t key = Key(vertexSource, fragmentSource);
+    std::string path = EntryPath(key);
+
+    std::ifstream stream(path, std::ios::binary);
+    ProgramBinaryHeader header;
+    if (!stream || !stream.read((char*)&header, sizeof(header))
+        || memcmp(header.Magic, "GLPB", 4) != 0 || header.Version != s_CacheVersion || header.Key != key)
+    {
+        m_Misses++;
+        return 0;
+    }
+    std::vector<char> binary(header.Length);
+    if (!stream.read(binary.data(), binary.size()))
+    {
+        m_Misses++;
+        return 0;
+    }
+
+    //not wrapped in GLCall, a driver refusing the binary is expected and
+    //shows up as a failed link rather than something to ASSERT on
+    unsigned int program = glCreateProgram();
+    glProgramBinary(program, header.Format, binary.data(), (GLsizei)binary.size());
+    int linked = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    GLClearError();
+    if (linked == GL_FALSE)
+    {
+        glDeleteProgram(program);
+        stream.close();
+        std::remove(path.c_str());
+        m_Rejected++;
+        m_Misses++;
+        return 0;
+    }
+
+    m_Hits++;
+    m_LoadMs += MsSince(start);
+    m_SavedMs += header.CompileMs;
+    return program;
+}
+
+void ProgramBinaryCache::Store(unsigned int program, std::string_view vertexSource, std::string_view fragmentSource, double compileMs)
+{
+    if (!m_Open)
+        return;
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_CompileMs += compileMs;
+
+    int linked = GL_FALSE;
+    GLCall(glGetProgramiv(program, GL_LINK_STATUS, &linked));
+    int length = 0;
+    GLCall(glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length));
+    if (linked == GL_FALSE || length <= 0)
+        return;
+
+    std::vector<char> binary(length);
+    GLenum format = 0;
+    GLCall(glGetProgramBinary(program, length, &length, &format, binary.data()));
+
+    ProgramBinaryHeader header = { { 'G', 'L', 'P', 'B' }, s_CacheVersion, Key(vertexSource, fragmentSource),
+        format, (uint32_t)length, compileMs };
+
+    //write next to the entry and rename, so a crash never leaves a torn entry behind
+    std::string path = EntryPath(header.Key);
+    std::string tempPath = path + ".tmp";
+    {
+        std::ofstream stream(tempPath, std::ios::binary);
+        stream.write((const char*)&header, sizeof(header));
+        stream.write(binary.data(), length);
+        if (!stream)
+        {
+            std::cout << "[ProgramCache] Failed to write " << tempPath << std::endl;
+            return;
+        }
+    }
+    std::error_code error;
+    std::filesystem::rename(tempPath, path, error);
+}
+
+void ProgramBinaryCache::PrintStats() const
+{
+    if (!m_Open)
+        return;
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    std::cout << "[ProgramCache] " << m_Hits << " hits, " << m_Misses << " misses";
+    if (m_Rejected)
+        std::cout << " (" << m_Rejected << " binaries rejected by the driver)";
+    std::cout << "\n  hits loaded in " << m_LoadMs << " ms instead of " << m_SavedMs
+        << " ms of compiling, saved " << m_SavedMs - m_LoadMs << " ms"
+        << "\n  misses spent " << m_CompileMs << " ms compiling" << std::endl;
+}
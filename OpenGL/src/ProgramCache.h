@@ -0,0 +1,51 @@
+#pragma once
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+//On-disk cache of linked programs (glGetProgramBinary / glProgramBinary).
+//
+//Entries are keyed by a 64-bit hash of the vertex and fragment source plus
+//GL_VENDOR, GL_RENDERER and GL_VERSION, so a driver update or a different GPU
+//simply misses instead of feeding the driver a binary it can't use. If the
+//driver still rejects a binary, the entry is deleted and CreateShader() falls
+//back to a full compile and link.
+//
+//Each entry remembers how long its original compile and link took, which is
+//what a hit saves. PrintStats() reports hits, misses and that saving.
+//Load/Store may be called from ShaderCompiler's worker threads.
+class ProgramBinaryCache
+{
+public:
+    static ProgramBinaryCache& Get();
+
+    //needs a current context, returns false (and stays closed) if the driver
+    //has no program binary formats
+    bool Open(const std::string& directory);
+    bool IsOpen() const { return m_Open; }
+
+    //returns a linked program, or 0 on a miss
+    unsigned int Load(std::string_view vertexSource, std::string_view fragmentSource);
+    //writes the binary of a freshly linked program, compileMs is how long it took to build
+    void Store(unsigned int program, std::string_view vertexSource, std::string_view fragmentSource, double compileMs);
+
+    void PrintStats() const;
+private:
+    ProgramBinaryCache() = default;
+
+    uint64_t Key(std::string_view vertexSource, std::string_view fragmentSource) const;
+    std::string EntryPath(uint64_t key) const;
+
+    mutable std::mutex m_Mutex;
+    bool m_Open = false;
+    std::string m_Directory;
+    std::string m_DriverId; //vendor, renderer and version, part of every key
+
+    unsigned int m_Hits = 0;
+    unsigned int m_Misses = 0;
+    unsigned int m_Rejected = 0;
+    double m_LoadMs = 0.0;     //time spent loading on hits
+    double m_SavedMs = 0.0;    //what those hits originally took to compile
+    double m_CompileMs = 0.0;  //time spent compiling on misses
+};
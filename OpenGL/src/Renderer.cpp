@@ -0,0 +1,90 @@
+#include "Renderer.h"
+#include "DebugSink.h"
+
+#include <iostream>
+
+void GLClearError()
+{
+    //runs through all the errors to clear it
+    while (glGetError() != GL_NO_ERROR);
+}
+
+bool GLLogCall(const char* function, const char* file, int line)
+{
+    //as long as the error is not false
+    while (GLenum error =glGetError()) {
+        //hand it to the background thread when it's running, printing here stalls the frame
+        if (!DebugSink::Get().Push(error, GL_DEBUG_SOURCE_API, GL_DEBUG_TYPE_ERROR, GL_DEBUG_SEVERITY_HIGH,
+            function, file, line, "glGetError"))
+            std::cout << "[OpenGL Error] (" << error << "): "
+                <<function<<" "<<file<<":"<<line << std::endl;
+        //the caller ASSERTs on false, let the message out first
+        DebugSink::Get().Flush();
+        return false;
+    }
+    return true;
+}
+
+struct GLCallSite
+{
+    const char* Function = nullptr;
+    const char* File = nullptr;
+    int Line = 0;
+};
+
+//the callback runs on the thread that made the call (GL_DEBUG_OUTPUT_SYNCHRONOUS),
+//so each thread keeps its own last call site
+static thread_local GLCallSite s_CallSite;
+
+void GLSetCallSite(const char* function, const char* file, int line)
+{
+    s_CallSite.Function = function;
+    s_CallSite.File = file;
+    s_CallSite.Line = line;
+}
+
+static void GLAPIENTRY GLDebugCallback(GLenum source, GLenum type, GLuint id, GLenum severity,
+    GLsizei length, const GLchar* message, const void* /*userParam*/)
+{
+    if (severity == GL_DEBUG_SEVERITY_NOTIFICATION)
+        return;
+
+    if (!DebugSink::Get().Push(id, source, type, severity, s_CallSite.Function, s_CallSite.File, s_CallSite.Line, message, length))
+    {
+        std::cout << "[OpenGL Debug] (" << id << "): " << message << std::endl;
+        if (s_CallSite.File)
+            std::cout << "    after " << s_CallSite.Function << " " << s_CallSite.File << ":" << s_CallSite.Line << std::endl;
+    }
+
+    if (type == GL_DEBUG_TYPE_ERROR)
+        DebugSink::Get().Flush();
+    ASSERT(type != GL_DEBUG_TYPE_ERROR);
+}
+
+bool GLEnableDebugOutput()
+{
+#if GL_ERROR_CHECK == GL_ERROR_CHECK_OFF && !defined(GL_DEBUG_WARNINGS)
+    //some drivers leave their fast path while debug output is on, release builds stay off it
+    return false;
+#else
+    if (!GLEW_KHR_debug && !GLEW_VERSION_4_3)
+    {
+        std::cout << "KHR_debug is not supported, driver warnings will not be reported" << std::endl;
+        return false;
+    }
+    glEnable(GL_DEBUG_OUTPUT);
+#if GL_ERROR_CHECK == GL_ERROR_CHECK_DEBUG_OUTPUT
+    //without this the driver may report the message later, from another thread,
+    //and the call site would point at the wrong GLCall
+    glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+#endif
+    glDebugMessageCallback(GLDebugCallback, nullptr);
+    glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, GL_DONT_CARE, 0, nullptr, GL_TRUE);
+#if GL_ERROR_CHECK != GL_ERROR_CHECK_DEBUG_OUTPUT
+    //errors are glGetError()'s job in the other modes (or deliberately unchecked),
+    //the callback is only here for the performance and portability warnings
+    glDebugMessageControl(GL_DONT_CARE, GL_DEBUG_TYPE_ERROR, GL_DONT_CARE, 0, nullptr, GL_FALSE);
+#endif
+    return true;
+#endif
+}
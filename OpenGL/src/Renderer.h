@@ -0,0 +1,67 @@
+#pragma once
+#include <GL/glew.h>
+
+//__debugbreak() is MSVC compiler specific
+#ifdef _MSC_VER
+#define DEBUG_BREAK() __debugbreak()
+#else
+#include <csignal>
+#define DEBUG_BREAK() raise(SIGTRAP)
+#endif
+#define ASSERT(x) if (!(x)) DEBUG_BREAK();
+
+//How GLCall checks for errors. It is picked at compile time, so a release
+//build doesn't pay for a single glGetError().
+//  GL_ERROR_CHECK_OFF           GLCall(x) is just x
+//  GL_ERROR_CHECK_FRAME         GLCall(x) is just x, GLCheckFrame() drains glGetError() once per frame
+//  GL_ERROR_CHECK_CALL          glGetError() around every call, reports the exact file:line
+//  GL_ERROR_CHECK_DEBUG_OUTPUT  the driver reports errors through a KHR_debug callback,
+//                               GLCall only remembers its file:line for the callback to print
+//Define GL_ERROR_CHECK to one of them in the project settings to override the default,
+//which is per call for debug builds and off when NDEBUG is defined.
+#define GL_ERROR_CHECK_OFF          0
+#define GL_ERROR_CHECK_FRAME        1
+#define GL_ERROR_CHECK_CALL         2
+#define GL_ERROR_CHECK_DEBUG_OUTPUT 3
+
+#ifndef GL_ERROR_CHECK
+#ifdef NDEBUG
+#define GL_ERROR_CHECK GL_ERROR_CHECK_OFF
+#else
+#define GL_ERROR_CHECK GL_ERROR_CHECK_CALL
+#endif
+#endif
+
+#if GL_ERROR_CHECK == GL_ERROR_CHECK_CALL
+#define GLCall(x) GLClearError();\
+    x;\
+    ASSERT(GLLogCall(#x, __FILE__, __LINE__))
+#elif GL_ERROR_CHECK == GL_ERROR_CHECK_DEBUG_OUTPUT
+#define GLCall(x) GLSetCallSite(#x, __FILE__, __LINE__);\
+    x
+#else
+#define GLCall(x) x
+#endif
+
+//Put once at the end of the render loop. Only does something with
+//GL_ERROR_CHECK_FRAME, where it is the one place errors get noticed.
+#if GL_ERROR_CHECK == GL_ERROR_CHECK_FRAME
+#define GLCheckFrame() ASSERT(GLLogCall("end of frame", __FILE__, __LINE__))
+#else
+#define GLCheckFrame()
+#endif
+
+void GLClearError();
+bool GLLogCall(const char* function, const char* file, int line);
+
+//Remembers the GLCall that is about to run on this thread, so the debug callback
+//can say which call caused a message. Cheap: three pointer stores.
+void GLSetCallSite(const char* function, const char* file, int line);
+
+//Installs the KHR_debug callback in every mode but GL_ERROR_CHECK_OFF, so driver
+//performance warnings reach DebugSink. Only GL_ERROR_CHECK_DEBUG_OUTPUT takes errors
+//from it too. Define GL_DEBUG_WARNINGS to keep the warnings in GL_ERROR_CHECK_OFF builds.
+//Call once after glewInit(). Returns false when it installed nothing: a release build,
+//or a context with no KHR_debug (GL 4.3), in which case GL_ERROR_CHECK_DEBUG_OUTPUT
+//builds won't see any errors.
+bool GLEnableDebugOutput();
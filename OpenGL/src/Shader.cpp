@@ -0,0 +1,124 @@
+#include "Shader.h"
+#include "ProgramCache.h"
+#include "Renderer.h"
+#include "ShaderReflection.h"
+
+#include <chrono>
+#include <iostream>
+#ifdef _MSC_VER
+#include <malloc.h>
+#else
+#include <alloca.h>
+#endif
+
+//Code to create a shader
+//the strings are meant to be the actual source code
+//you can bring in shaders as a string or pull them from another file
+unsigned int CompileShader(unsigned int type,std::string_view source)
+{
+    unsigned int id = glCreateShader(type);
+    //data returns a pointer to the first char
+    //source needs to exist at this point when you compile this code
+    //or it can point to random memory and cause an error
+    const char* src = source.data();
+    //takes a pointer to the pointer and a length to the string
+    //a string_view isn't null terminated (it can point into the middle of a
+    //mapped shader file), so we pass the length instead of nullptr
+    int length = (int)source.size();
+    glShaderSource(id, 1, &src, &length);
+    glCompileShader(id);// doesn't return anything, but can be queried
+
+    int result;
+    glGetShaderiv(id, GL_COMPILE_STATUS, &result);
+    if (result == GL_FALSE)
+    {
+        int length;
+        glGetShaderiv(id, GL_INFO_LOG_LENGTH, &length);
+        //some people use heap memory to get the message and delete it
+        //but this little hack lets you use stack memory to get the message
+        //alloca is a function that C gives you that allocate on the stack dynamically
+        char* message= (char*)alloca(length*sizeof(char));
+        glGetShaderInfoLog(id, length, &length, message);
+        //There are more than two types of shaders, but for this demo, it's enough
+        std::cout << "Failed to compile "<<(type==GL_VERTEX_SHADER?"vertex":"fragment") << " shader"<< std::endl;
+        std::cout << message << std::endl;
+        glDeleteShader(id);
+        return 0;
+    }
+    //TODO: Error handling
+    return id;
+}
+unsigned int CreateShader(std::string_view vertexShader, std::string_view fragmentShader)
+{
+    //a program linked by an earlier run with the same sources and driver
+    //loads straight from its binary, no compile or link at all
+    ProgramBinaryCache& cache = ProgramBinaryCache::Get();
+    if (unsigned int cached = cache.Load(vertexShader, fragmentShader))
+    {
+        ReflectProgram(cached);
+        return cached;
+    }
+    auto start = std::chrono::steady_clock::now();
+
+    unsigned int vs = CompileShader(GL_VERTEX_SHADER, vertexShader);
+    unsigned int fs = CompileShader(GL_FRAGMENT_SHADER, fragmentShader);
+    //attaching shader 0 is GL_INVALID_VALUE, there is nothing to link anyway
+    if (!vs || !fs)
+    {
+        if (vs)
+        {
+            GLCall(glDeleteShader(vs));
+        }
+        if (fs)
+        {
+            GLCall(glDeleteShader(fs));
+        }
+        return 0;
+    }
+
+    //returns an unsigned int
+    //you can use GLuint but if you use something besides opengl, your code won't be as compatible
+    unsigned int program = glCreateProgram();
+    //has to be set before linking or the driver may not keep a binary around
+    if (cache.IsOpen())
+    {
+        GLCall(glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE));
+    }
+
+    //Now we attach the shaders to the program and link it
+    GLCall(glAttachShader(program, vs));
+    GLCall(glAttachShader(program, fs));
+    GLCall(glLinkProgram(program));
+    GLCall(glValidateProgram(program));
+
+    //After the shaders have been linked, we can delete the "intermediates"
+    //technically we should be called glDetachShader, to get rid of the source code
+    //but it can be useful for debuggin with the downside of taking up a trival amount
+    //of memory. A lot of game engines don't bother detaching.
+    //that topic will discussed later on
+    GLCall(glDeleteShader(vs));
+    GLCall(glDeleteShader(fs));
+
+    //read every uniform/attribute location once now, so nobody has to
+    //glGetUniformLocation by string later (see ShaderReflection.h)
+    int linked = GL_FALSE;
+    GLCall(glGetProgramiv(program, GL_LINK_STATUS, &linked));
+    if (linked)
+        ReflectProgram(program);
+
+    if (cache.IsOpen())
+    {
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        cache.Store(program, vertexShader, fragmentShader, elapsed.count());
+    }
+    return program;
+}
+
+bool IsLinked(unsigned int program)
+{
+    if (!program)
+        return false;
+    int linked = GL_FALSE;
+    GLCall(glGetProgramiv(program, GL_LINK_STATUS, &linked));
+    return linked == GL_TRUE;
+}
@@ -0,0 +1,16 @@
+#pragma once
+#include "ShaderParser.h"
+#include <string_view>
+
+//Compiles one stage, returns 0 and prints the info log when it fails
+unsigned int CompileShader(unsigned int type, std::string_view source);
+
+//Compiles and links a program from the two stages.
+//Returns 0 if a stage fails to compile; a link failure still returns the
+//program, check GL_LINK_STATUS (or IsLinked()) before using it.
+//Goes through ProgramBinaryCache::Get() first when the cache is open.
+//A linked program is reflected, GetProgramReflection() has its uniforms.
+unsigned int CreateShader(std::string_view vertexShader, std::string_view fragmentShader);
+
+//false for 0 too, so it can go straight after CreateShader()
+bool IsLinked(unsigned int program);
@@ -0,0 +1,123 @@
+#include "ShaderArchive.h"
+#include "ShaderReflection.h"
+
+#include <GL/glew.h>
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+//"./a/b" and "a/b" name the same program, and the packer stores the latter
+static std::string_view TrimName(std::string_view name)
+{
+    while (name.size() >= 2 && name[0] == '.' && name[1] == '/')
+        name.remove_prefix(2);
+    return name;
+}
+
+bool ShaderArchive::Open(const std::string& filepath)
+{
+    Close();
+    if (!m_File.Open(filepath))
+        return false;
+
+    std::string_view data = m_File.GetData();
+    ShaderArchiveHeader header;
+    if (data.size() < sizeof(header))
+    {
+        std::cout << "[ShaderArchive] " << filepath << " is too small to be an archive" << std::endl;
+        m_File.Close();
+        return false;
+    }
+    memcpy(&header, data.data(), sizeof(header));
+    size_t tablesEnd = sizeof(header) + (size_t)header.ProgramCount * sizeof(ShaderArchiveEntry)
+        + (size_t)header.StageCount * sizeof(ShaderArchiveStage);
+    if (memcmp(header.Magic, "GLSA", 4) != 0 || header.Version != s_ShaderArchiveVersion || tablesEnd > data.size())
+    {
+        std::cout << "[ShaderArchive] " << filepath << " isn't a version " << s_ShaderArchiveVersion << " archive" << std::endl;
+        m_File.Close();
+        return false;
+    }
+
+    //the mapping is page aligned and the tables are multiples of 8 bytes, so these casts are aligned
+    const ShaderArchiveEntry* entries = (const ShaderArchiveEntry*)(data.data() + sizeof(header));
+    const ShaderArchiveStage* stages = (const ShaderArchiveStage*)(entries + header.ProgramCount);
+    for (unsigned int i = 0; i < header.ProgramCount; i++)
+    {
+        const ShaderArchiveEntry& entry = entries[i];
+        bool valid = (size_t)entry.NameOffset + entry.NameLength < data.size()
+            && (size_t)entry.FirstStage + entry.StageCount <= header.StageCount
+            && (i == 0 || entries[i - 1].NameHash <= entry.NameHash);
+        for (unsigned int s = 0; valid && s < entry.StageCount; s++)
+        {
+            const ShaderArchiveStage& stage = stages[entry.FirstStage + s];
+            valid = (size_t)stage.SourceOffset + stage.SourceLength < data.size();
+        }
+        if (!valid)
+        {
+            std::cout << "[ShaderArchive] " << filepath << " is corrupt" << std::endl;
+            m_File.Close();
+            return false;
+        }
+    }
+
+    m_Entries = entries;
+    m_Stages = stages;
+    m_ProgramCount = header.ProgramCount;
+    return true;
+}
+
+const ShaderArchiveEntry* ShaderArchive::FindEntry(std::string_view name) const
+{
+    if (!IsOpen())
+        return nullptr;
+    name = TrimName(name);
+    uint64_t hash = HashName(name);
+    const ShaderArchiveEntry* end = m_Entries + m_ProgramCount;
+    const ShaderArchiveEntry* entry = std::lower_bound(m_Entries, end, hash,
+        [](const ShaderArchiveEntry& e, uint64_t h) { return e.NameHash < h; });
+    //the name is compared too, two paths could share a hash
+    for (; entry != end && entry->NameHash == hash; entry++)
+    {
+        std::string_view entryName(m_File.GetData().data() + entry->NameOffset, entry->NameLength);
+        if (entryName == name)
+            return entry;
+    }
+    return nullptr;
+}
+
+std::vector<ShaderStageView> ShaderArchive::Find(std::string_view name) const
+{
+    std::vector<ShaderStageView> result;
+    const ShaderArchiveEntry* entry = FindEntry(name);
+    if (!entry)
+        return result;
+    const char* base = m_File.GetData().data();
+    for (unsigned int i = 0; i < entry->StageCount; i++)
+    {
+        const ShaderArchiveStage& stage = m_Stages[entry->FirstStage + i];
+        ShaderStageView view;
+        view.Type = stage.Type;
+        view.Source = std::string_view(base + stage.SourceOffset, stage.SourceLength);
+        result.push_back(view);
+    }
+    return result;
+}
+
+bool ShaderArchive::Find(std::string_view name, std::string_view& vertexSource, std::string_view& fragmentSource) const
+{
+    vertexSource = fragmentSource = {};
+    const ShaderArchiveEntry* entry = FindEntry(name);
+    if (!entry)
+        return false;
+    //no vector here, this is the startup path
+    const char* base = m_File.GetData().data();
+    for (unsigned int i = 0; i < entry->StageCount; i++)
+    {
+        const ShaderArchiveStage& stage = m_Stages[entry->FirstStage + i];
+        if (stage.Type == GL_VERTEX_SHADER)
+            vertexSource = std::string_view(base + stage.SourceOffset, stage.SourceLength);
+        else if (stage.Type == GL_FRAGMENT_SHADER)
+            fragmentSource = std::string_view(base + stage.SourceOffset, stage.SourceLength);
+    }
+    return !vertexSource.empty() && !fragmentSource.empty();
+}
@@ -0,0 +1,71 @@
+#pragma once
+#include "MappedFile.h"
+#include "ShaderParser.h"
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+//On-disk layout of a shader archive (.pack), written by the ShaderPacker tool.
+//
+//  ShaderArchiveHeader
+//  ShaderArchiveEntry[ProgramCount]   sorted by NameHash
+//  ShaderArchiveStage[StageCount]     each entry's stages are contiguous
+//  names and stage sources            every string null terminated
+//
+//All offsets are from the start of the file. Sources are stored already
+//#include expanded and split into stages, so loading needs no parsing.
+struct ShaderArchiveHeader
+{
+    char Magic[4];          //"GLSA"
+    uint32_t Version;
+    uint32_t ProgramCount;
+    uint32_t StageCount;
+};
+
+struct ShaderArchiveEntry
+{
+    uint64_t NameHash;      //HashName() of the path the program was packed from, e.g. "res/shaders/Basic.shader"
+    uint32_t NameOffset;
+    uint32_t NameLength;
+    uint32_t FirstStage;
+    uint32_t StageCount;
+};
+
+struct ShaderArchiveStage
+{
+    uint32_t Type;          //GL_VERTEX_SHADER etc.
+    uint32_t SourceOffset;
+    uint32_t SourceLength;  //without the terminating null
+    uint32_t Reserved;
+};
+
+static const uint32_t s_ShaderArchiveVersion = 1;
+
+//A .pack file mapped into memory.
+//Find() is a binary search over the directory and the stages it returns
+//point into the mapping, so they can go straight to glShaderSource and stay
+//valid for as long as the archive is open.
+class ShaderArchive
+{
+public:
+    //checks the header and that every offset stays inside the file
+    bool Open(const std::string& filepath);
+    void Close() { m_File.Close(); m_Entries = nullptr; m_Stages = nullptr; m_ProgramCount = 0; }
+    bool IsOpen() const { return m_Entries != nullptr; }
+
+    //stages of the program packed from name ("./res/shaders/Basic.shader" and
+    //"res/shaders/Basic.shader" are the same), empty if it isn't in the archive
+    std::vector<ShaderStageView> Find(std::string_view name) const;
+    //the vertex and fragment stage of a program, false if it isn't in the archive
+    bool Find(std::string_view name, std::string_view& vertexSource, std::string_view& fragmentSource) const;
+
+    unsigned int GetProgramCount() const { return m_ProgramCount; }
+private:
+    const ShaderArchiveEntry* FindEntry(std::string_view name) const;
+
+    MappedFile m_File;
+    const ShaderArchiveEntry* m_Entries = nullptr;
+    const ShaderArchiveStage* m_Stages = nullptr;
+    unsigned int m_ProgramCount = 0;
+};
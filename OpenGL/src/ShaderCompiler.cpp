@@ -0,0 +1,241 @@
+#include "ShaderCompiler.h"
+#include "ProgramCache.h"
+#include "Renderer.h"
+#include "Shader.h"
+#include "ShaderReflection.h"
+
+#include <iostream>
+
+static void PrintInfoLog(unsigned int id, bool isProgram)
+{
+    int length = 0;
+    if (isProgram)
+        glGetProgramiv(id, GL_INFO_LOG_LENGTH, &length);
+    else
+        glGetShaderiv(id, GL_INFO_LOG_LENGTH, &length);
+    if (length <= 0)
+        return;
+
+    std::string message(length, '\0');
+    if (isProgram)
+        glGetProgramInfoLog(id, length, &length, &message[0]);
+    else
+        glGetShaderInfoLog(id, length, &length, &message[0]);
+    std::cout << message << std::endl;
+}
+
+ShaderCompiler::ShaderCompiler(std::vector<SharedContext> workerContexts)
+{
+    m_ParallelCompile = GLEW_KHR_parallel_shader_compile || GLEW_ARB_parallel_shader_compile;
+    if (m_ParallelCompile)
+    {
+        //0xFFFFFFFF lets the driver pick how many threads to use
+        if (GLEW_KHR_parallel_shader_compile)
+            glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+        else
+            glMaxShaderCompilerThreadsARB(0xFFFFFFFF);
+        return;
+    }
+
+    for (SharedContext& context : workerContexts)
+        m_Workers.emplace_back(&ShaderCompiler::WorkerLoop, this, context);
+}
+
+ShaderCompiler::~ShaderCompiler()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_QueueMutex);
+        m_Quit = true;
+    }
+    m_QueueReady.notify_all();
+    for (std::thread& worker : m_Workers)
+        worker.join();
+}
+
+ShaderCompiler::Handle ShaderCompiler::Submit(std::string_view vertexShader, std::string_view fragmentShader, bool borrowSources)
+{
+    Handle handle = (Handle)m_Jobs.size();
+    Job& job = m_Jobs.emplace_back();
+    if (borrowSources)
+    {
+        job.VertexSource = vertexShader;
+        job.FragmentSource = fragmentShader;
+    }
+    else
+    {
+        job.OwnedVertexSource = vertexShader;
+        job.OwnedFragmentSource = fragmentShader;
+        job.VertexSource = job.OwnedVertexSource;
+        job.FragmentSource = job.OwnedFragmentSource;
+    }
+    job.Start = std::chrono::steady_clock::now();
+
+    if (m_ParallelCompile)
+    {
+        ProgramBinaryCache& cache = ProgramBinaryCache::Get();
+        if ((job.Program = cache.Load(vertexShader, fragmentShader)))
+        {
+            ReflectProgram(job.Program);
+            job.State = Status::Ready;
+            return handle;
+        }
+
+        //issue everything now and don't ask for any status, the driver
+        //compiles and links on its own threads until Poll() finds it done
+        job.Program = glCreateProgram();
+        if (cache.IsOpen())
+        {
+            GLCall(glProgramParameteri(job.Program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE));
+        }
+        const char* vertexSource = job.VertexSource.data();
+        const char* fragmentSource = job.FragmentSource.data();
+        int vertexLength = (int)job.VertexSource.size();
+        int fragmentLength = (int)job.FragmentSource.size();
+        job.VertexShader = glCreateShader(GL_VERTEX_SHADER);
+        job.FragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
+        GLCall(glShaderSource(job.VertexShader, 1, &vertexSource, &vertexLength));
+        GLCall(glShaderSource(job.FragmentShader, 1, &fragmentSource, &fragmentLength));
+        GLCall(glCompileShader(job.VertexShader));
+        GLCall(glCompileShader(job.FragmentShader));
+        GLCall(glAttachShader(job.Program, job.VertexShader));
+        GLCall(glAttachShader(job.Program, job.FragmentShader));
+        GLCall(glLinkProgram(job.Program));
+        return handle;
+    }
+
+    if (m_Workers.empty())
+    {
+        //0 when a stage didn't compile, CompileShader() has printed why
+        job.Program = CreateShader(vertexShader, fragmentShader);
+        bool linked = IsLinked(job.Program);
+        if (job.Program && !linked)
+        {
+            std::cout << "Failed to link program" << std::endl;
+            PrintInfoLog(job.Program, true);
+            GLCall(glDeleteProgram(job.Program));
+            job.Program = 0;
+        }
+        job.State = linked ? Status::Ready : Status::Failed;
+        return handle;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_QueueMutex);
+        m_Queue.push_back(&job);
+    }
+    m_QueueReady.notify_one();
+    return handle;
+}
+
+ShaderCompiler::Status ShaderCompiler::FinishParallelJob(Job& job)
+{
+    int completed = GL_FALSE;
+    GLCall(glGetProgramiv(job.Program, GL_COMPLETION_STATUS_KHR, &completed));
+    if (!completed)
+        return Status::Pending;
+
+    int linked = GL_FALSE;
+    GLCall(glGetProgramiv(job.Program, GL_LINK_STATUS, &linked));
+    if (linked)
+    {
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - job.Start;
+        ProgramBinaryCache::Get().Store(job.Program, job.VertexSource, job.FragmentSource, elapsed.count());
+        ReflectProgram(job.Program);
+    }
+    else
+    {
+        //same output CompileShader() gives, plus the link log
+        unsigned int shaders[] = { job.VertexShader, job.FragmentShader };
+        for (unsigned int shader : shaders)
+        {
+            int compiled = GL_FALSE;
+            GLCall(glGetShaderiv(shader, GL_COMPILE_STATUS, &compiled));
+            if (compiled)
+                continue;
+            std::cout << "Failed to compile " << (shader == job.VertexShader ? "vertex" : "fragment") << " shader" << std::endl;
+            PrintInfoLog(shader, false);
+        }
+        std::cout << "Failed to link program" << std::endl;
+        PrintInfoLog(job.Program, true);
+        GLCall(glDeleteProgram(job.Program));
+        job.Program = 0;
+    }
+
+    GLCall(glDeleteShader(job.VertexShader));
+    GLCall(glDeleteShader(job.FragmentShader));
+    job.VertexShader = 0;
+    job.FragmentShader = 0;
+    job.State = linked ? Status::Ready : Status::Failed;
+    return job.State;
+}
+
+ShaderCompiler::Status ShaderCompiler::Poll(Handle handle)
+{
+    Job& job = m_Jobs[handle];
+    Status state = job.State.load(std::memory_order_acquire);
+    if (state != Status::Pending || !m_ParallelCompile)
+        return state;
+    return FinishParallelJob(job);
+}
+
+unsigned int ShaderCompiler::GetProgram(Handle handle) const
+{
+    const Job& job = m_Jobs[handle];
+    return job.State.load(std::memory_order_acquire) == Status::Ready ? job.Program : 0;
+}
+
+unsigned int ShaderCompiler::Wait(Handle handle)
+{
+    Job& job = m_Jobs[handle];
+    if (m_ParallelCompile && job.State == Status::Pending)
+    {
+        //asking for the link status waits for the driver to finish
+        int linked = GL_FALSE;
+        GLCall(glGetProgramiv(job.Program, GL_LINK_STATUS, &linked));
+    }
+    while (Poll(handle) == Status::Pending)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    return GetProgram(handle);
+}
+
+unsigned int ShaderCompiler::GetPendingCount() const
+{
+    unsigned int pending = 0;
+    for (const Job& job : m_Jobs)
+        pending += job.State.load(std::memory_order_relaxed) == Status::Pending;
+    return pending;
+}
+
+void ShaderCompiler::WorkerLoop(SharedContext context)
+{
+    context.MakeCurrent();
+    while (true)
+    {
+        Job* job;
+        {
+            std::unique_lock<std::mutex> lock(m_QueueMutex);
+            m_QueueReady.wait(lock, [this] { return m_Quit || !m_Queue.empty(); });
+            if (m_Quit)
+                break;
+            job = m_Queue.front();
+            m_Queue.pop_front();
+        }
+
+        //0 when a stage didn't compile, CompileShader() has printed why
+        unsigned int program = CreateShader(job->VertexSource, job->FragmentSource);
+        bool linked = IsLinked(program);
+        if (program && !linked)
+        {
+            std::cout << "Failed to link program" << std::endl;
+            PrintInfoLog(program, true);
+            GLCall(glDeleteProgram(program));
+            program = 0;
+        }
+        //the program has to be completely built before the main context touches it
+        glFinish();
+
+        job->Program = program;
+        job->State.store(linked ? Status::Ready : Status::Failed, std::memory_order_release);
+    }
+    context.DoneCurrent();
+}
@@ -0,0 +1,89 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+//A context that shares objects with the main one, for a compile worker to make current
+struct SharedContext
+{
+    std::function<void()> MakeCurrent;
+    std::function<void()> DoneCurrent;
+};
+
+//Builds programs without stalling the render loop.
+//
+//Submit() every program up front, then Poll() the handles once a frame and
+//start using a program when it reports Ready. How the work overlaps depends
+//on what the driver has:
+//  - KHR/ARB_parallel_shader_compile: Submit() issues glCompileShader/glLinkProgram
+//    right away and the driver compiles on its own threads, Poll() only asks
+//    GL_COMPLETION_STATUS_KHR, which never blocks
+//  - otherwise, with shared contexts: worker threads run CreateShader() on their
+//    own context, programs are shared objects so the handle is valid on the main one
+//  - neither: Submit() compiles synchronously, like calling CreateShader()
+//Programs still go through ProgramBinaryCache, a cache hit is Ready on Submit().
+//All functions must be called from the thread that owns the main context.
+class ShaderCompiler
+{
+public:
+    typedef unsigned int Handle;
+
+    enum class Status
+    {
+        Pending, Ready, Failed
+    };
+
+    //the worker contexts are only used without parallel_shader_compile,
+    //one worker thread is started per context
+    explicit ShaderCompiler(std::vector<SharedContext> workerContexts = {});
+    ~ShaderCompiler();
+
+    ShaderCompiler(const ShaderCompiler&) = delete;
+    ShaderCompiler& operator=(const ShaderCompiler&) = delete;
+
+    //the sources are copied, unless borrowSources says they outlive the job
+    //(a mapped ShaderArchive does), then only the views are kept
+    Handle Submit(std::string_view vertexShader, std::string_view fragmentShader, bool borrowSources = false);
+    Status Poll(Handle handle);
+    //0 until Poll() has reported Ready
+    unsigned int GetProgram(Handle handle) const;
+    //blocks until the program is finished, for when it's needed right now
+    unsigned int Wait(Handle handle);
+
+    //true when the driver does the compiling in the background itself
+    bool UsesParallelCompile() const { return m_ParallelCompile; }
+    //how many submitted programs are still Pending
+    unsigned int GetPendingCount() const;
+private:
+    struct Job
+    {
+        std::string_view VertexSource;
+        std::string_view FragmentSource;
+        std::string OwnedVertexSource; //what the views point at when the sources were copied
+        std::string OwnedFragmentSource;
+        unsigned int Program = 0;
+        unsigned int VertexShader = 0;
+        unsigned int FragmentShader = 0;
+        std::atomic<Status> State{ Status::Pending };
+        std::chrono::steady_clock::time_point Start;
+    };
+
+    void WorkerLoop(SharedContext context);
+    Status FinishParallelJob(Job& job);
+
+    bool m_ParallelCompile = false;
+    std::deque<Job> m_Jobs; //deque so Job addresses stay valid while workers hold them
+
+    std::vector<std::thread> m_Workers;
+    std::deque<Job*> m_Queue;
+    std::mutex m_QueueMutex;
+    std::condition_variable m_QueueReady;
+    bool m_Quit = false;
+};
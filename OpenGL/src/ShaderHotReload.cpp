@@ -0,0 +1,133 @@
+#include "ShaderHotReload.h"
+#include "Renderer.h"
+#include "ShaderParser.h"
+#include "ShaderPreprocessor.h"
+#include "ShaderReflection.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <iostream>
+
+static std::string NormalizePath(const std::string& filepath)
+{
+    return std::filesystem::path(filepath).lexically_normal().generic_string();
+}
+
+ShaderHotReloader::ShaderHotReloader(ShaderCompiler& compiler)
+    : m_Compiler(compiler)
+{
+}
+
+ShaderHotReloader::~ShaderHotReloader()
+{
+    m_Watcher.Stop();
+}
+
+bool ShaderHotReloader::Start()
+{
+    if (!m_Watcher.Start())
+        return false;
+    for (const Entry& entry : m_Entries)
+        WatchWithIncludes(entry.Filepath);
+    return true;
+}
+
+ShaderHotReloader::Handle ShaderHotReloader::Add(const std::string& filepath, unsigned int program)
+{
+    Entry entry;
+    entry.Filepath = NormalizePath(filepath);
+    entry.Program = program;
+    m_Entries.push_back(entry);
+    WatchWithIncludes(entry.Filepath);
+    return (Handle)(m_Entries.size() - 1);
+}
+
+void ShaderHotReloader::WatchWithIncludes(const std::string& filepath)
+{
+    m_Watcher.Watch(filepath);
+    ShaderPreprocessor& preprocessor = ShaderPreprocessor::Get();
+    for (const std::string& include : preprocessor.GetIncludes(filepath))
+        WatchWithIncludes(include);
+}
+
+std::vector<ShaderHotReloader::Handle> ShaderHotReloader::Update()
+{
+    std::vector<Handle> swapped;
+
+    //programs whose rebuild finished since last frame
+    for (Handle handle = 0; handle < m_Entries.size(); handle++)
+    {
+        Entry& entry = m_Entries[handle];
+        if (!entry.Rebuilding)
+            continue;
+        ShaderCompiler::Status status = m_Compiler.Poll(entry.Job);
+        if (status == ShaderCompiler::Status::Pending)
+            continue;
+        entry.Rebuilding = false;
+        if (status == ShaderCompiler::Status::Failed)
+        {
+            std::cout << "[HotReload] " << entry.Filepath << " failed to build, keeping the last good program" << std::endl;
+            continue;
+        }
+
+        ForgetProgramReflection(entry.Program);
+        GLCall(glDeleteProgram(entry.Program));
+        entry.Program = m_Compiler.GetProgram(entry.Job);
+        std::cout << "[HotReload] Reloaded " << entry.Filepath << std::endl;
+        swapped.push_back(handle);
+    }
+
+    for (size_t i = 0; i < m_Superseded.size();)
+    {
+        if (m_Compiler.Poll(m_Superseded[i]) == ShaderCompiler::Status::Pending)
+        {
+            i++;
+            continue;
+        }
+        if (unsigned int program = m_Compiler.GetProgram(m_Superseded[i]))
+        {
+            ForgetProgramReflection(program);
+            GLCall(glDeleteProgram(program));
+        }
+        m_Superseded.erase(m_Superseded.begin() + i);
+    }
+
+    std::vector<std::string> changes = m_Watcher.TakeChanges();
+    if (changes.empty())
+        return swapped;
+
+    //a change to a header affects every file that includes it. Files that were
+    //never expanded (no #include) aren't in the graph, they only affect themselves
+    ShaderPreprocessor& preprocessor = ShaderPreprocessor::Get();
+    std::vector<std::string> affected;
+    for (const std::string& change : changes)
+    {
+        std::vector<std::string> files = preprocessor.Invalidate(change);
+        files.push_back(change);
+        for (std::string& file : files)
+        {
+            if (std::find(affected.begin(), affected.end(), file) == affected.end())
+                affected.push_back(std::move(file));
+        }
+    }
+
+    for (Entry& entry : m_Entries)
+    {
+        if (std::find(affected.begin(), affected.end(), entry.Filepath) == affected.end())
+            continue;
+        ShaderProgramSource source = ParseShader(entry.Filepath);
+        if (source.VertexSource.empty() || source.FragmentSource.empty())
+        {
+            std::cout << "[HotReload] " << entry.Filepath << " is missing a stage, keeping the last good program" << std::endl;
+            continue;
+        }
+        //a rebuild still in flight is out of date now
+        if (entry.Rebuilding)
+            m_Superseded.push_back(entry.Job);
+        entry.Job = m_Compiler.Submit(source.VertexSource, source.FragmentSource);
+        entry.Rebuilding = true;
+        //the edit may have added includes in directories nobody watches yet
+        WatchWithIncludes(entry.Filepath);
+    }
+    return swapped;
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include "FileWatcher.h"
+#include "ShaderCompiler.h"
+#include <string>
+#include <vector>
+
+//Rebuilds programs whose shader files (or anything they #include) change on disk.
+//
+//FileWatcher notices the writes on its own thread. Update(), called once per
+//frame between frames, asks ShaderPreprocessor which files the changes
+//affect, re-parses only those and submits them to the ShaderCompiler, which
+//compiles off the render thread. When a rebuild is Ready, a later Update()
+//swaps it in and deletes the old program, so a frame only ever draws with
+//one complete program. If a rebuild fails the error is printed and the last
+//good program stays in use. Main thread only.
+class ShaderHotReloader
+{
+public:
+    typedef unsigned int Handle;
+
+    explicit ShaderHotReloader(ShaderCompiler& compiler);
+    ~ShaderHotReloader();
+
+    ShaderHotReloader(const ShaderHotReloader&) = delete;
+    ShaderHotReloader& operator=(const ShaderHotReloader&) = delete;
+
+    //false when file watching isn't available, Add() and Update() still work then but never reload
+    bool Start();
+
+    //takes over program, which was built from filepath. The reloader deletes
+    //the programs it replaces, the caller deletes the final one.
+    Handle Add(const std::string& filepath, unsigned int program);
+    unsigned int GetProgram(Handle handle) const { return m_Entries[handle].Program; }
+
+    //call at a frame boundary, returns the handles whose program changed this call
+    //(they need glUseProgram and their uniform bindings set again)
+    std::vector<Handle> Update();
+private:
+    struct Entry
+    {
+        std::string Filepath;
+        unsigned int Program = 0;
+        bool Rebuilding = false;
+        ShaderCompiler::Handle Job = 0;
+    };
+
+    void WatchWithIncludes(const std::string& filepath);
+
+    ShaderCompiler& m_Compiler;
+    FileWatcher m_Watcher;
+    std::vector<Entry> m_Entries;
+    //rebuilds replaced by a newer edit before they finished, deleted once they do
+    std::vector<ShaderCompiler::Handle> m_Superseded;
+};
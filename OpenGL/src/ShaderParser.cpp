@@ -0,0 +1,103 @@
+#include "ShaderParser.h"
+#include "MappedFile.h"
+#include "ShaderPreprocessor.h"
+
+#include <GL/glew.h>
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+unsigned int ShaderTypeFromName(std::string_view name)
+{
+    if (name == "vertex")
+        return GL_VERTEX_SHADER;
+    if (name == "fragment" || name == "pixel")
+        return GL_FRAGMENT_SHADER;
+    if (name == "geometry")
+        return GL_GEOMETRY_SHADER;
+    if (name == "tess_control")
+        return GL_TESS_CONTROL_SHADER;
+    if (name == "tess_evaluation")
+        return GL_TESS_EVALUATION_SHADER;
+    if (name == "compute")
+        return GL_COMPUTE_SHADER;
+    return 0;
+}
+
+static bool IsBlank(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+std::vector<ShaderStageView> ParseShaderStages(std::string_view text)
+{
+    static const std::string_view directive = "#shader";
+    std::vector<ShaderStageView> stages;
+    const char* begin = text.data();
+    const char* end = begin + text.size();
+
+    for (const char* line = begin; line < end;)
+    {
+        const char* lineEnd = (const char*)memchr(line, '\n', end - line);
+        if (!lineEnd)
+            lineEnd = end;
+        const char* next = lineEnd < end ? lineEnd + 1 : end;
+
+        const char* c = line;
+        while (c < lineEnd && IsBlank(*c))
+            c++;
+        if ((size_t)(lineEnd - c) >= directive.size() && memcmp(c, directive.data(), directive.size()) == 0)
+        {
+            //the previous stage ends where this directive line starts
+            if (!stages.empty())
+                stages.back().Source = std::string_view(stages.back().Source.data(), line - stages.back().Source.data());
+
+            c += directive.size();
+            while (c < lineEnd && IsBlank(*c))
+                c++;
+            const char* nameEnd = c;
+            while (nameEnd < lineEnd && !IsBlank(*nameEnd))
+                nameEnd++;
+
+            ShaderStageView stage;
+            stage.Name = std::string_view(c, nameEnd - c);
+            stage.Type = ShaderTypeFromName(stage.Name);
+            stage.Source = std::string_view(next, 0);
+            stages.push_back(stage);
+        }
+        line = next;
+    }
+
+    if (!stages.empty())
+        stages.back().Source = std::string_view(stages.back().Source.data(), end - stages.back().Source.data());
+    return stages;
+}
+
+ShaderProgramSource ParseShader(const std::string& filepath)
+{
+    ShaderProgramSource source;
+    MappedFile file(filepath);
+    if (!file.IsOpen())
+    {
+        std::cout << "Failed to open " << filepath << std::endl;
+        return source;
+    }
+
+    //files without an #include are split straight out of the mapping, the
+    //rest go through the preprocessor, which keeps the expanded text around
+    std::string_view text = file.GetData();
+    std::string_view include = "#include";
+    if (std::search(text.begin(), text.end(), include.begin(), include.end()) != text.end())
+        text = ShaderPreprocessor::Get().Expand(filepath);
+
+    for (const ShaderStageView& stage : ParseShaderStages(text))
+    {
+        if (stage.Type == GL_VERTEX_SHADER)
+            source.VertexSource.assign(stage.Source);
+        else if (stage.Type == GL_FRAGMENT_SHADER)
+            source.FragmentSource.assign(stage.Source);
+        else
+            std::cout << "Unknown shader type \"" << stage.Name << "\" in " << filepath << std::endl;
+    }
+    return source;
+}
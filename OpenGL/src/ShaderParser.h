@@ -0,0 +1,89 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <vector>
+
+struct ShaderProgramSource 
+{
+    std::string VertexSource;
+    std::string FragmentSource;
+};
+
+//One "#shader <name>" section of a shader file.
+//Source points into the text that was parsed, nothing is copied.
+struct ShaderStageView
+{
+    std::string_view Name;  //"vertex", "fragment", ...
+    unsigned int Type;      //GL_VERTEX_SHADER etc., 0 for a name we don't know
+    std::string_view Source;
+};
+
+//GL shader type for a #shader name, 0 if it isn't one
+unsigned int ShaderTypeFromName(std::string_view name);
+
+//Single pass over the text: every line that starts with "#shader" begins a
+//new stage, and that stage's source is the bytes up to the next directive.
+//Any number of stages is fine and text before the first directive is ignored.
+std::vector<ShaderStageView> ParseShaderStages(std::string_view text);
+
+//Splits a file with "#shader vertex" / "#shader fragment" sections into the two sources.
+//Memory-maps the file and copies each stage out once. A file with #include
+//lines is expanded by ShaderPreprocessor first.
+ShaderProgramSource ParseShader(const std::string& filepath);
+
+//The vertex/fragment split of ParseShader() as a constexpr function, for
+//shaders embedded in the executable (ShaderPacker --header). Both views point
+//into text, so with text a string literal the stages are pre-split in the
+//binary and nothing runs at startup. Missing stages come back empty.
+struct EmbeddedShaderSource
+{
+    std::string_view VertexSource;
+    std::string_view FragmentSource;
+};
+
+constexpr EmbeddedShaderSource SplitShaderSections(std::string_view text)
+{
+    EmbeddedShaderSource result{};
+    int current = -1; //0 vertex, 1 fragment, -1 a stage we don't keep
+    size_t currentStart = 0;
+    auto isBlank = [](char c) { return c == ' ' || c == '\t' || c == '\r'; };
+    auto finish = [&](size_t end)
+    {
+        if (current == 0)
+            result.VertexSource = text.substr(currentStart, end - currentStart);
+        else if (current == 1)
+            result.FragmentSource = text.substr(currentStart, end - currentStart);
+    };
+
+    for (size_t line = 0; line < text.size();)
+    {
+        size_t lineEnd = text.find('\n', line);
+        if (lineEnd == std::string_view::npos)
+            lineEnd = text.size();
+        size_t next = lineEnd < text.size() ? lineEnd + 1 : text.size();
+
+        size_t c = line;
+        while (c < lineEnd && isBlank(text[c]))
+            c++;
+        if (text.substr(c, lineEnd - c).substr(0, 7) == "#shader")
+        {
+            finish(line);
+            c += 7;
+            while (c < lineEnd && isBlank(text[c]))
+                c++;
+            size_t nameEnd = c;
+            while (nameEnd < lineEnd && !isBlank(text[nameEnd]))
+                nameEnd++;
+            std::string_view name = text.substr(c, nameEnd - c);
+            current = name == "vertex" ? 0 : (name == "fragment" || name == "pixel") ? 1 : -1;
+            currentStart = next;
+        }
+        line = next;
+    }
+    finish(text.size());
+    return result;
+}
+
+static_assert(SplitShaderSections("#shader vertex\nv\n#shader fragment\nf\n").VertexSource == "v\n"
+    && SplitShaderSections("#shader vertex\nv\n#shader fragment\nf\n").FragmentSource == "f\n",
+    "SplitShaderSections has to split the same way ParseShaderStages does");
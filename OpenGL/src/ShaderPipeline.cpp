@@ -0,0 +1,134 @@
+#include "ShaderPipeline.h"
+#include "Renderer.h"
+#include "ShaderReflection.h"
+
+#include <chrono>
+#include <iostream>
+#include <string>
+
+static double MsSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+static const char* StageName(unsigned int type)
+{
+    return type == GL_VERTEX_SHADER ? "vertex" : type == GL_FRAGMENT_SHADER ? "fragment" : "other";
+}
+
+ShaderPipelineCache& ShaderPipelineCache::Get()
+{
+    static ShaderPipelineCache cache;
+    return cache;
+}
+
+bool ShaderPipelineCache::IsSupported()
+{
+    return GLEW_VERSION_4_1 || GLEW_ARB_separate_shader_objects;
+}
+
+unsigned int ShaderPipelineCache::GetStage(unsigned int type, std::string_view source)
+{
+    //the type goes into the hash, the same text can't be both stages anyway
+    //but a vertex and a fragment stage mustn't ever share a slot
+    uint64_t key = HashName(source) ^ ((uint64_t)type * 0x9E3779B97F4A7C15ull);
+    auto it = m_Stages.find(key);
+    if (it != m_Stages.end())
+    {
+        m_StageHits++;
+        return it->second;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    //glCreateShaderProgramv wants null terminated strings
+    std::string text(source);
+    const char* src = text.c_str();
+    unsigned int program = glCreateShaderProgramv(type, 1, &src);
+    GLClearError(); //a failed compile shows up as a failed link below, not as a GL error
+
+    int linked = GL_FALSE;
+    if (program)
+        glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    if (!linked)
+    {
+        std::cout << "[ShaderPipeline] Failed to build separable " << StageName(type) << " stage" << std::endl;
+        int length = 0;
+        if (program)
+            glGetProgramiv(program, GL_INFO_LOG_LENGTH, &length);
+        if (length > 0)
+        {
+            std::string message(length, '\0');
+            glGetProgramInfoLog(program, length, &length, &message[0]);
+            std::cout << message << std::endl;
+        }
+        if (program)
+        {
+            GLCall(glDeleteProgram(program));
+        }
+        program = 0;
+    }
+    else
+        ReflectProgram(program);
+
+    m_StageLinks++;
+    m_StageMs += MsSince(start);
+    m_Stages[key] = program;
+    return program;
+}
+
+unsigned int ShaderPipelineCache::GetPipeline(unsigned int vertexStage, unsigned int fragmentStage)
+{
+    if (!vertexStage || !fragmentStage)
+        return 0;
+
+    uint64_t key = ((uint64_t)vertexStage << 32) | fragmentStage;
+    auto it = m_Pipelines.find(key);
+    if (it != m_Pipelines.end())
+    {
+        m_PipelineHits++;
+        return it->second;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    unsigned int pipeline = 0;
+    GLCall(glGenProgramPipelines(1, &pipeline));
+    GLCall(glUseProgramStages(pipeline, GL_VERTEX_SHADER_BIT, vertexStage));
+    GLCall(glUseProgramStages(pipeline, GL_FRAGMENT_SHADER_BIT, fragmentStage));
+    m_PipelineMs += MsSince(start);
+
+    m_Pipelines[key] = pipeline;
+    return pipeline;
+}
+
+unsigned int ShaderPipelineCache::GetPipeline(std::string_view vertexSource, std::string_view fragmentSource)
+{
+    return GetPipeline(GetStage(GL_VERTEX_SHADER, vertexSource), GetStage(GL_FRAGMENT_SHADER, fragmentSource));
+}
+
+void ShaderPipelineCache::Destroy()
+{
+    for (auto& [key, pipeline] : m_Pipelines)
+    {
+        GLCall(glDeleteProgramPipelines(1, &pipeline));
+    }
+    for (auto& [key, program] : m_Stages)
+    {
+        if (!program)
+            continue;
+        ForgetProgramReflection(program);
+        GLCall(glDeleteProgram(program));
+    }
+    m_Pipelines.clear();
+    m_Stages.clear();
+}
+
+void ShaderPipelineCache::PrintStats() const
+{
+    if (m_StageLinks == 0)
+        return;
+    std::cout << "[ShaderPipeline] " << m_StageLinks << " stages linked in " << m_StageMs << " ms, "
+        << m_Pipelines.size() << " pipelines made in " << m_PipelineMs << " ms"
+        << "\n  " << m_StageHits << " stage and " << m_PipelineHits << " pipeline lookups were already built"
+        << "\n  a linked program per pair would have been " << m_Pipelines.size() << " links instead of "
+        << m_StageLinks << std::endl;
+}
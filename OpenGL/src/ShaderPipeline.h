@@ -0,0 +1,53 @@
+#pragma once
+#include <cstdint>
+#include <string_view>
+#include <unordered_map>
+
+//Separable stage programs combined by program pipeline objects
+//(ARB_separate_shader_objects, core in 4.1).
+//
+//CreateShader() links one program per vertex+fragment pair, so N vertex and
+//M fragment variants cost N*M links. Here every stage is compiled and linked
+//on its own once (glCreateShaderProgramv), and a pipeline object just points
+//at a vertex and a fragment stage, which costs no link at all:
+//  unsigned int vs = pipelines.GetStage(GL_VERTEX_SHADER, vertexSource);
+//  unsigned int fs = pipelines.GetStage(GL_FRAGMENT_SHADER, fragmentSource);
+//  GLCall(glBindProgramPipeline(pipelines.GetPipeline(vs, fs)));
+//Stages are keyed by a hash of their type and source, pipelines by their two
+//stages, so asking again is a map lookup. Nothing is bound with glUseProgram,
+//uniforms go through glProgramUniform* on the stage that declares them, and
+//the stages have to agree on their in/out variables by location.
+//Every stage is reflected, GetProgramReflection(stage) has its uniforms.
+//Main thread only.
+class ShaderPipelineCache
+{
+public:
+    static ShaderPipelineCache& Get();
+
+    //needs a current context
+    static bool IsSupported();
+
+    //a separable program for one stage, 0 (and the log printed) if it doesn't build.
+    //Failures are remembered, the same broken source isn't compiled again
+    unsigned int GetStage(unsigned int type, std::string_view source);
+    //a pipeline with the two stages, 0 if either is 0
+    unsigned int GetPipeline(unsigned int vertexStage, unsigned int fragmentStage);
+    //both of the above in one go
+    unsigned int GetPipeline(std::string_view vertexSource, std::string_view fragmentSource);
+
+    //deletes every stage and pipeline, needs the context still current
+    void Destroy();
+    //stages built, pipelines made and how many links a linked program per pair would have cost
+    void PrintStats() const;
+private:
+    ShaderPipelineCache() = default;
+
+    std::unordered_map<uint64_t, unsigned int> m_Stages;
+    std::unordered_map<uint64_t, unsigned int> m_Pipelines; //vertex stage << 32 | fragment stage
+
+    unsigned int m_StageLinks = 0;
+    double m_StageMs = 0.0;
+    double m_PipelineMs = 0.0;
+    unsigned int m_StageHits = 0;
+    unsigned int m_PipelineHits = 0;
+};
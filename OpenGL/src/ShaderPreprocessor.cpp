@@ -0,0 +1,188 @@
+#include "ShaderPreprocessor.h"
+#include "MappedFile.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <string_view>
+
+static uint64_t HashContents(std::string_view data)
+{
+    //FNV-1a, same as the program cache keys
+    uint64_t hash = 14695981039346656037ull;
+    for (char c : data)
+        hash = (hash ^ (unsigned char)c) * 1099511628211ull;
+    return hash;
+}
+
+static bool IsBlank(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+//the quoted name of an `#include "name"` line, empty for any other line
+static std::string_view IncludeName(const char* line, const char* lineEnd)
+{
+    static const std::string_view directive = "#include";
+    const char* c = line;
+    while (c < lineEnd && IsBlank(*c))
+        c++;
+    if ((size_t)(lineEnd - c) < directive.size() || memcmp(c, directive.data(), directive.size()) != 0)
+        return {};
+    c += directive.size();
+    while (c < lineEnd && IsBlank(*c))
+        c++;
+    if (c == lineEnd || *c != '"')
+        return {};
+    const char* nameEnd = (const char*)memchr(c + 1, '"', lineEnd - c - 1);
+    if (!nameEnd)
+        return {};
+    return std::string_view(c + 1, nameEnd - c - 1);
+}
+
+ShaderPreprocessor& ShaderPreprocessor::Get()
+{
+    static ShaderPreprocessor preprocessor;
+    return preprocessor;
+}
+
+std::string ShaderPreprocessor::Normalize(const std::string& filepath)
+{
+    //"a/../b.glsl" and "b.glsl" have to end up as the same node
+    return std::filesystem::path(filepath).lexically_normal().generic_string();
+}
+
+const std::string& ShaderPreprocessor::Expand(const std::string& filepath)
+{
+    std::vector<std::string> stack;
+    return Expand(Normalize(filepath), stack);
+}
+
+const std::string& ShaderPreprocessor::Expand(const std::string& path, std::vector<std::string>& stack)
+{
+    FileNode& node = m_Files[path];
+    if (node.Expanded)
+    {
+        m_Reuses++;
+        return node.Text;
+    }
+
+    MappedFile file(path);
+    if (!file.IsOpen())
+    {
+        std::cout << "[ShaderPreprocessor] Failed to open " << path << std::endl;
+        node.Text.clear();
+        return node.Text;
+    }
+    m_Expands++;
+    std::string_view data = file.GetData();
+    std::string directory = std::filesystem::path(path).parent_path().generic_string();
+    stack.push_back(path);
+
+    std::string text;
+    text.reserve(data.size());
+    std::vector<std::string> includes;
+    const char* begin = data.data();
+    const char* end = begin + data.size();
+    //copies runs of ordinary lines in one go, only include lines break them up
+    const char* copyFrom = begin;
+    int lineNumber = 1;
+    for (const char* line = begin; line < end; lineNumber++)
+    {
+        const char* lineEnd = (const char*)memchr(line, '\n', end - line);
+        if (!lineEnd)
+            lineEnd = end;
+        const char* next = lineEnd < end ? lineEnd + 1 : end;
+
+        std::string_view name = IncludeName(line, lineEnd);
+        if (!name.empty())
+        {
+            text.append(copyFrom, line - copyFrom);
+            copyFrom = next;
+
+            std::string includePath = Normalize(directory.empty() ? std::string(name) : directory + "/" + std::string(name));
+            if (std::find(stack.begin(), stack.end(), includePath) != stack.end())
+            {
+                std::cout << "[ShaderPreprocessor] " << path << ":" << lineNumber << " includes " << includePath
+                    << ", which is already being included" << std::endl;
+            }
+            else
+            {
+                if (std::find(includes.begin(), includes.end(), includePath) == includes.end())
+                    includes.push_back(includePath);
+                const std::string& header = Expand(includePath, stack);
+                text += header;
+                if (!header.empty() && header.back() != '\n')
+                    text += '\n';
+            }
+        }
+        line = next;
+    }
+    text.append(copyFrom, end - copyFrom);
+    stack.pop_back();
+
+    //node is still good, unordered_map never moves its elements
+    node.ContentHash = HashContents(data);
+    node.Text = std::move(text);
+    node.Expanded = true;
+    SetIncludes(path, std::move(includes));
+    return node.Text;
+}
+
+void ShaderPreprocessor::SetIncludes(const std::string& path, std::vector<std::string> includes)
+{
+    FileNode& node = m_Files[path];
+    for (const std::string& include : node.Includes)
+        m_Files[include].IncludedBy.erase(path);
+    for (const std::string& include : includes)
+        m_Files[include].IncludedBy.insert(path);
+    node.Includes = std::move(includes);
+}
+
+std::vector<std::string> ShaderPreprocessor::Invalidate(const std::string& filepath)
+{
+    std::string path = Normalize(filepath);
+    auto it = m_Files.find(path);
+    if (it == m_Files.end() || !it->second.Expanded)
+        return {};
+
+    MappedFile file(path);
+    uint64_t hash = file.IsOpen() ? HashContents(file.GetData()) : 0;
+    if (file.IsOpen() && hash == it->second.ContentHash)
+        return {};
+
+    std::vector<std::string> affected = GetDependents(path);
+    affected.insert(affected.begin(), path);
+    for (const std::string& dependent : affected)
+        m_Files[dependent].Expanded = false;
+    return affected;
+}
+
+std::vector<std::string> ShaderPreprocessor::GetDependents(const std::string& filepath) const
+{
+    std::vector<std::string> dependents;
+    std::vector<std::string> pending = { Normalize(filepath) };
+    while (!pending.empty())
+    {
+        std::string path = std::move(pending.back());
+        pending.pop_back();
+        auto it = m_Files.find(path);
+        if (it == m_Files.end())
+            continue;
+        for (const std::string& parent : it->second.IncludedBy)
+        {
+            if (std::find(dependents.begin(), dependents.end(), parent) != dependents.end())
+                continue;
+            dependents.push_back(parent);
+            pending.push_back(parent);
+        }
+    }
+    return dependents;
+}
+
+std::vector<std::string> ShaderPreprocessor::GetIncludes(const std::string& filepath) const
+{
+    auto it = m_Files.find(Normalize(filepath));
+    return it != m_Files.end() ? it->second.Includes : std::vector<std::string>();
+}
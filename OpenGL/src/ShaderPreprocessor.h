@@ -0,0 +1,62 @@
+#pragma once
+#include <cstdint>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+//Expands #include "file" lines in shader files.
+//
+//Each file is read and expanded once. The result is kept along with the
+//hash of the file's own contents and the files it includes, and every
+//include is recorded as an edge in a dependency graph. When a file changes
+//on disk, Invalidate() compares the new contents' hash with the old one and,
+//if it really changed, drops the expansion of that file and of every file
+//that includes it, directly or through other headers. Its return value is
+//exactly the set of files whose programs need rebuilding, nothing else.
+//
+//Paths in #include are relative to the including file. Headers are pasted
+//every time they're included (there's no #pragma once), an include cycle is
+//reported and the line left out. Main thread only.
+class ShaderPreprocessor
+{
+public:
+    static ShaderPreprocessor& Get();
+
+    //the file with every #include replaced by the expanded header, empty if it can't be read.
+    //The reference stays valid until the file is invalidated.
+    const std::string& Expand(const std::string& filepath);
+
+    //call when filepath may have changed on disk. Returns filepath and every file
+    //that includes it if the contents changed, nothing if they're the same
+    //(an editor re-saving an unchanged file) or the file was never expanded.
+    std::vector<std::string> Invalidate(const std::string& filepath);
+
+    //every file that includes filepath, directly or indirectly
+    std::vector<std::string> GetDependents(const std::string& filepath) const;
+    //files filepath includes directly, as of its last expansion
+    std::vector<std::string> GetIncludes(const std::string& filepath) const;
+
+    //how many times a file was actually read and expanded, vs served from memory
+    unsigned int GetExpandCount() const { return m_Expands; }
+    unsigned int GetReuseCount() const { return m_Reuses; }
+private:
+    ShaderPreprocessor() = default;
+
+    struct FileNode
+    {
+        uint64_t ContentHash = 0;    //of the file itself, not the expansion
+        bool Expanded = false;       //false once invalidated, Text is stale then
+        std::string Text;
+        std::vector<std::string> Includes;
+        std::set<std::string> IncludedBy;
+    };
+
+    static std::string Normalize(const std::string& filepath);
+    const std::string& Expand(const std::string& path, std::vector<std::string>& stack);
+    void SetIncludes(const std::string& path, std::vector<std::string> includes);
+
+    std::unordered_map<std::string, FileNode> m_Files;
+    unsigned int m_Expands = 0;
+    unsigned int m_Reuses = 0;
+};
@@ -0,0 +1,173 @@
+#include "ShaderReflection.h"
+#include "Renderer.h"
+#include "UniformState.h"
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+//Every active uniform (or attribute) with a location, arrays twice, and how many actives that was
+static std::vector<std::pair<std::string, UniformHandle>> QueryActive(unsigned int program, bool uniforms, unsigned int& activeCount)
+{
+    std::vector<std::pair<std::string, UniformHandle>> result;
+    int count = 0;
+    int maxLength = 0;
+    GLCall(glGetProgramiv(program, uniforms ? GL_ACTIVE_UNIFORMS : GL_ACTIVE_ATTRIBUTES, &count));
+    GLCall(glGetProgramiv(program, uniforms ? GL_ACTIVE_UNIFORM_MAX_LENGTH : GL_ACTIVE_ATTRIBUTE_MAX_LENGTH, &maxLength));
+    std::string name(std::max(maxLength, 1), '\0');
+
+    for (int i = 0; i < count; i++)
+    {
+        int length = 0;
+        int size = 0;
+        GLenum type = 0;
+        if (uniforms)
+        {
+            GLCall(glGetActiveUniform(program, i, (GLsizei)name.size(), &length, &size, &type, &name[0]));
+        }
+        else
+        {
+            GLCall(glGetActiveAttrib(program, i, (GLsizei)name.size(), &length, &size, &type, &name[0]));
+        }
+        std::string activeName(name.data(), length);
+
+        int location = -1;
+        if (uniforms)
+        {
+            GLCall(location = glGetUniformLocation(program, activeName.c_str()));
+        }
+        else
+        {
+            GLCall(location = glGetAttribLocation(program, activeName.c_str()));
+        }
+        //block members and built-ins like gl_VertexID have no location
+        if (location == -1)
+            continue;
+
+        activeCount++;
+        UniformHandle handle{ location, type, size };
+        //"u_Lights[0]" is also reachable as "u_Lights"
+        if (activeName.size() > 3 && activeName.compare(activeName.size() - 3, 3, "[0]") == 0)
+            result.emplace_back(activeName.substr(0, activeName.size() - 3), handle);
+        result.emplace_back(std::move(activeName), handle);
+    }
+    return result;
+}
+
+ProgramReflection::ProgramReflection(unsigned int program)
+    : m_Program(program)
+{
+    std::vector<Entry> entries;
+    for (auto& [name, handle] : QueryActive(program, true, m_UniformCount))
+    {
+        //array uniforms come back under two names, list them once
+        if (name.back() != ']' || name.compare(name.size() - 3, 3, "[0]") != 0)
+            m_UniformList.push_back(handle);
+        entries.push_back({ HashName(name), handle });
+    }
+    Build(m_Uniforms, entries);
+
+    int blockCount = 0;
+    int maxLength = 0;
+    GLCall(glGetProgramiv(program, GL_ACTIVE_UNIFORM_BLOCKS, &blockCount));
+    GLCall(glGetProgramiv(program, GL_ACTIVE_UNIFORM_BLOCK_MAX_NAME_LENGTH, &maxLength));
+    std::string name(std::max(maxLength, 1), '\0');
+    for (int i = 0; i < blockCount; i++)
+    {
+        int length = 0;
+        UniformBlockHandle block{ i, 0 };
+        GLCall(glGetActiveUniformBlockName(program, i, (GLsizei)name.size(), &length, &name[0]));
+        GLCall(glGetActiveUniformBlockiv(program, i, GL_UNIFORM_BLOCK_DATA_SIZE, &block.DataSize));
+        m_Blocks.emplace_back(HashName(std::string_view(name.data(), length)), block);
+    }
+
+    entries.clear();
+    for (auto& [name, handle] : QueryActive(program, false, m_AttributeCount))
+    {
+        if (name.back() != ']' || name.compare(name.size() - 3, 3, "[0]") != 0)
+            m_AttributeList.push_back(handle);
+        entries.push_back({ HashName(name), handle });
+    }
+    Build(m_Attributes, entries);
+}
+
+UniformBlockHandle ProgramReflection::GetUniformBlock(uint64_t nameHash) const
+{
+    for (const auto& [hash, block] : m_Blocks)
+    {
+        if (hash == nameHash)
+            return block;
+    }
+    return {};
+}
+
+void ProgramReflection::Build(Table& table, const std::vector<Entry>& entries)
+{
+    if (entries.empty())
+        return;
+
+    //start at a load factor of at most 1/2 and double whenever a few hundred
+    //seeds in a row can't place every entry in its own slot
+    unsigned int bits = 1;
+    while ((1ull << bits) < entries.size() * 2)
+        bits++;
+    std::vector<bool> used;
+    for (;; bits++)
+    {
+        table.Shift = 64 - bits;
+        table.Slots.assign((size_t)1 << bits, Entry());
+        for (uint64_t seed = 0; seed < 256; seed++)
+        {
+            table.Seed = seed;
+            used.assign(table.Slots.size(), false);
+            bool collided = false;
+            for (const Entry& entry : entries)
+            {
+                size_t slot = Slot(table, entry.Hash);
+                if (used[slot])
+                {
+                    collided = true;
+                    break;
+                }
+                used[slot] = true;
+            }
+            if (collided)
+                continue;
+
+            for (const Entry& entry : entries)
+                table.Slots[Slot(table, entry.Hash)] = entry;
+            return;
+        }
+        //two names with the same 64-bit hash can never be separated
+        ASSERT(bits < 24);
+    }
+}
+
+static std::mutex s_ReflectionMutex;
+//unique_ptr so the pointers handed out stay put while other programs are added
+static std::unordered_map<unsigned int, std::unique_ptr<ProgramReflection>> s_Reflections;
+
+void ReflectProgram(unsigned int program)
+{
+    if (!program)
+        return;
+    auto reflection = std::make_unique<ProgramReflection>(program);
+    std::lock_guard<std::mutex> lock(s_ReflectionMutex);
+    s_Reflections[program] = std::move(reflection);
+}
+
+const ProgramReflection* GetProgramReflection(unsigned int program)
+{
+    std::lock_guard<std::mutex> lock(s_ReflectionMutex);
+    auto it = s_Reflections.find(program);
+    return it != s_Reflections.end() ? it->second.get() : nullptr;
+}
+
+void ForgetProgramReflection(unsigned int program)
+{
+    ForgetUniformState(program);
+    std::lock_guard<std::mutex> lock(s_ReflectionMutex);
+    s_Reflections.erase(program);
+}
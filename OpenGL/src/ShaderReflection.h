@@ -0,0 +1,117 @@
+#pragma once
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+//64-bit FNV-1a of a uniform or attribute name. constexpr, so a name used at a
+//call site can be hashed at compile time:
+//  constexpr uint64_t s_Color = HashName("u_Color");
+constexpr uint64_t HashName(std::string_view name)
+{
+    uint64_t hash = 14695981039346656037ull;
+    for (char c : name)
+        hash = (hash ^ (unsigned char)c) * 1099511628211ull;
+    return hash;
+}
+
+//What glGetActiveUniform/glGetActiveAttrib reported for one name.
+//Type is the GL type (GL_FLOAT_VEC4, ...) so a call site can check it
+//matches the glUniform* it is about to make. Location is -1 when the name
+//isn't active in the program, which is what glGetUniformLocation would give.
+struct UniformHandle
+{
+    int Location = -1;
+    unsigned int Type = 0;
+    int Count = 0; //array length, 1 for a plain uniform
+
+    bool IsValid() const { return Location != -1; }
+    bool Is(unsigned int type) const { return Type == type; }
+};
+typedef UniformHandle AttributeHandle;
+
+//An active uniform block: the index glUniformBlockBinding takes and the
+//byte size the driver laid it out with (GL_UNIFORM_BLOCK_DATA_SIZE)
+struct UniformBlockHandle
+{
+    int Index = -1;
+    int DataSize = 0;
+
+    bool IsValid() const { return Index != -1; }
+};
+
+//Every active uniform and attribute of one linked program, read once after linking.
+//
+//Names live in a small perfect-hash table: the table size and seed are
+//searched at build time until every name lands in its own slot, so a lookup
+//is one multiply, one shift and one compare, no strings and no probing.
+//Arrays are reachable both as "name" and "name[0]", like glGetUniformLocation.
+//Uniforms inside uniform blocks have no location and are left out, the
+//blocks themselves are listed separately.
+class ProgramReflection
+{
+public:
+    //needs the program's context (or one sharing with it) current
+    explicit ProgramReflection(unsigned int program);
+
+    UniformHandle GetUniform(uint64_t nameHash) const { return Find(m_Uniforms, nameHash); }
+    UniformHandle GetUniform(std::string_view name) const { return GetUniform(HashName(name)); }
+    AttributeHandle GetAttribute(uint64_t nameHash) const { return Find(m_Attributes, nameHash); }
+    AttributeHandle GetAttribute(std::string_view name) const { return GetAttribute(HashName(name)); }
+
+    //a program has a handful of blocks at most and they're looked up once, so no table
+    UniformBlockHandle GetUniformBlock(uint64_t nameHash) const;
+    UniformBlockHandle GetUniformBlock(std::string_view name) const { return GetUniformBlock(HashName(name)); }
+
+    //one handle per active uniform with a location, in no particular order
+    const std::vector<UniformHandle>& GetUniforms() const { return m_UniformList; }
+    //one handle per active vertex input with a location, in no particular order
+    const std::vector<AttributeHandle>& GetAttributes() const { return m_AttributeList; }
+
+    unsigned int GetProgram() const { return m_Program; }
+    unsigned int GetUniformCount() const { return m_UniformCount; }
+    unsigned int GetAttributeCount() const { return m_AttributeCount; }
+private:
+    struct Entry
+    {
+        uint64_t Hash = 0;
+        UniformHandle Handle;
+    };
+    struct Table
+    {
+        std::vector<Entry> Slots;
+        uint64_t Seed = 0;
+        unsigned int Shift = 64;
+    };
+
+    static size_t Slot(const Table& table, uint64_t hash)
+    {
+        return (size_t)(((hash ^ table.Seed) * 0x9E3779B97F4A7C15ull) >> table.Shift);
+    }
+    static UniformHandle Find(const Table& table, uint64_t hash)
+    {
+        if (table.Slots.empty())
+            return {};
+        const Entry& entry = table.Slots[Slot(table, hash)];
+        return entry.Hash == hash ? entry.Handle : UniformHandle();
+    }
+    static void Build(Table& table, const std::vector<Entry>& entries);
+
+    unsigned int m_Program;
+    unsigned int m_UniformCount = 0;
+    unsigned int m_AttributeCount = 0;
+    Table m_Uniforms;
+    Table m_Attributes;
+    std::vector<UniformHandle> m_UniformList;
+    std::vector<AttributeHandle> m_AttributeList;
+    std::vector<std::pair<uint64_t, UniformBlockHandle>> m_Blocks;
+};
+
+//Reflection for every program CreateShader()/ShaderCompiler has linked.
+//Reflect() is called right after linking (from whichever thread linked),
+//call sites fetch the table once when the program is ready and keep the
+//handles, so nothing on the per-frame path touches a name or a lock.
+void ReflectProgram(unsigned int program);
+//nullptr if the program was never reflected
+const ProgramReflection* GetProgramReflection(unsigned int program);
+//call alongside glDeleteProgram, GL reuses program names. Drops the program's UniformState too
+void ForgetProgramReflection(unsigned int program);
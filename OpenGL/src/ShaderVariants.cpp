@@ -0,0 +1,153 @@
+#include "ShaderVariants.h"
+#include "Renderer.h"
+#include "Shader.h"
+#include "ShaderPipeline.h"
+#include "ShaderReflection.h"
+
+#include <chrono>
+#include <iostream>
+
+std::string InjectDefines(std::string_view source, std::string_view defines)
+{
+    //#version has to stay the first thing the compiler sees
+    size_t insertAt = 0;
+    size_t version = source.find("#version");
+    if (version != std::string_view::npos)
+    {
+        size_t lineEnd = source.find('\n', version);
+        insertAt = lineEnd == std::string_view::npos ? source.size() : lineEnd + 1;
+    }
+
+    std::string result;
+    result.reserve(source.size() + defines.size() + 1);
+    result.append(source.substr(0, insertAt));
+    if (insertAt > 0 && result.back() != '\n')
+        result += '\n';
+    result.append(defines);
+    result.append(source.substr(insertAt));
+    return result;
+}
+
+//"LIGHT_COUNT 4" is named LIGHT_COUNT
+static std::string_view KeywordName(std::string_view keyword)
+{
+    return keyword.substr(0, keyword.find_first_of(" \t"));
+}
+
+ShaderVariantSet::ShaderVariantSet(const std::string& filepath, std::vector<std::string> keywords)
+    : m_Filepath(filepath), m_Source(ParseShader(filepath)), m_Keywords(std::move(keywords))
+{
+    ASSERT(m_Keywords.size() <= MaxKeywords);
+}
+
+uint64_t ShaderVariantSet::Mask(std::initializer_list<std::string_view> names) const
+{
+    uint64_t mask = 0;
+    for (std::string_view name : names)
+    {
+        bool found = false;
+        for (size_t i = 0; i < m_Keywords.size(); i++)
+        {
+            if (KeywordName(m_Keywords[i]) == name)
+            {
+                mask |= 1ull << i;
+                found = true;
+                break;
+            }
+        }
+        if (!found)
+            std::cout << "[ShaderVariants] " << m_Filepath << " has no keyword " << name << std::endl;
+    }
+    return mask;
+}
+
+std::string ShaderVariantSet::DefinesFor(uint64_t mask) const
+{
+    std::string defines;
+    for (size_t i = 0; i < m_Keywords.size(); i++)
+    {
+        if (mask & (1ull << i))
+            defines += "#define " + m_Keywords[i] + "\n";
+    }
+    return defines;
+}
+
+ShaderProgramSource ShaderVariantSet::GetSource(uint64_t mask) const
+{
+    std::string defines = DefinesFor(mask);
+    return { InjectDefines(m_Source.VertexSource, defines), InjectDefines(m_Source.FragmentSource, defines) };
+}
+
+unsigned int ShaderVariantSet::Get(uint64_t mask)
+{
+    auto it = m_Programs.find(mask);
+    if (it != m_Programs.end())
+        return it->second;
+
+    auto start = std::chrono::steady_clock::now();
+    ShaderProgramSource source = GetSource(mask);
+    unsigned int program = CreateShader(source.VertexSource, source.FragmentSource);
+    if (!IsLinked(program))
+    {
+        std::cout << "[ShaderVariants] " << m_Filepath << " variant " << std::hex << mask << std::dec
+            << " failed to build" << std::endl;
+        if (program)
+        {
+            GLCall(glDeleteProgram(program));
+        }
+        program = 0;
+    }
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    m_BuildMs += elapsed.count();
+
+    //a failed variant is remembered too, so it isn't recompiled every frame
+    m_Programs[mask] = program;
+    return program;
+}
+
+void ShaderVariantSet::PrintStats() const
+{
+    if (m_Programs.empty())
+        return;
+    std::cout << "[ShaderVariants] " << m_Filepath << ": " << m_Programs.size() << " variants built in "
+        << m_BuildMs << " ms" << std::endl;
+}
+
+unsigned int ShaderVariantSet::GetPipeline(uint64_t vertexMask, uint64_t fragmentMask)
+{
+    ShaderPipelineCache& pipelines = ShaderPipelineCache::Get();
+
+    auto vertex = m_VertexStages.find(vertexMask);
+    if (vertex == m_VertexStages.end())
+    {
+        std::string source = InjectDefines(m_Source.VertexSource, DefinesFor(vertexMask));
+        vertex = m_VertexStages.emplace(vertexMask, pipelines.GetStage(GL_VERTEX_SHADER, source)).first;
+    }
+    auto fragment = m_FragmentStages.find(fragmentMask);
+    if (fragment == m_FragmentStages.end())
+    {
+        std::string source = InjectDefines(m_Source.FragmentSource, DefinesFor(fragmentMask));
+        fragment = m_FragmentStages.emplace(fragmentMask, pipelines.GetStage(GL_FRAGMENT_SHADER, source)).first;
+    }
+    return pipelines.GetPipeline(vertex->second, fragment->second);
+}
+
+void ShaderVariantSet::Precompile(const std::vector<uint64_t>& masks)
+{
+    for (uint64_t mask : masks)
+        Get(mask);
+}
+
+void ShaderVariantSet::Destroy()
+{
+    for (auto& [mask, program] : m_Programs)
+    {
+        if (!program)
+            continue;
+        ForgetProgramReflection(program);
+        GLCall(glDeleteProgram(program));
+    }
+    m_Programs.clear();
+    m_VertexStages.clear();
+    m_FragmentStages.clear();
+}
@@ -0,0 +1,69 @@
+#pragma once
+#include "ShaderParser.h"
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+//Every #define combination of one shader file, built only when first asked for.
+//
+//The set is given a list of keywords, bit i of a variant mask turns on
+//keyword i. A keyword is the text after #define, so it can carry a value:
+//  ShaderVariantSet basic("res/shaders/Basic.shader", { "USE_TEXTURE", "LIGHT_COUNT 4" });
+//  unsigned int program = basic.Get(basic.Mask({ "USE_TEXTURE" }));
+//The file is parsed once. Get() injects the mask's #defines right after
+//#version and compiles through CreateShader() (so the program binary cache
+//and reflection work per variant) the first time a mask is seen, later calls
+//are a hash map lookup. Precompile() is for the masks that have to be ready
+//before the first frame.
+//GetPipeline() takes a mask per stage instead and goes through
+//ShaderPipelineCache: each stage variant is built once on its own, so N
+//vertex and M fragment masks cost N+M links rather than N*M. Main thread only.
+class ShaderVariantSet
+{
+public:
+    static const unsigned int MaxKeywords = 64;
+
+    ShaderVariantSet(const std::string& filepath, std::vector<std::string> keywords);
+
+    ShaderVariantSet(const ShaderVariantSet&) = delete;
+    ShaderVariantSet& operator=(const ShaderVariantSet&) = delete;
+
+    //mask with the named keywords on, a keyword is named by the part before any value
+    uint64_t Mask(std::initializer_list<std::string_view> names) const;
+
+    //the program for a mask, compiled on first use. 0 if it failed to compile.
+    unsigned int Get(uint64_t mask);
+    void Precompile(const std::vector<uint64_t>& masks);
+    bool IsCompiled(uint64_t mask) const { return m_Programs.count(mask) != 0; }
+    size_t GetCompiledCount() const { return m_Programs.size(); }
+    //how many variants Get() built and the time it spent on them, nothing if it built none
+    void PrintStats() const;
+
+    //a program pipeline with the vertex stage built for one mask and the fragment
+    //stage for another, 0 if either failed. Needs ShaderPipelineCache::IsSupported()
+    unsigned int GetPipeline(uint64_t vertexMask, uint64_t fragmentMask);
+
+    //the sources Get() would compile, for handing to ShaderCompiler instead
+    ShaderProgramSource GetSource(uint64_t mask) const;
+
+    //deletes every variant's program, needs the context still current.
+    //Not done by a destructor, the context may already be gone by then.
+    //Pipeline stages belong to ShaderPipelineCache and are left alone
+    void Destroy();
+private:
+    std::string DefinesFor(uint64_t mask) const;
+
+    std::string m_Filepath;
+    ShaderProgramSource m_Source;
+    std::vector<std::string> m_Keywords;
+    std::unordered_map<uint64_t, unsigned int> m_Programs;
+    double m_BuildMs = 0.0;
+    //per stage mask -> separable stage, owned by ShaderPipelineCache
+    std::unordered_map<uint64_t, unsigned int> m_VertexStages;
+    std::unordered_map<uint64_t, unsigned int> m_FragmentStages;
+};
+
+//source with the #define lines put after its #version line (or at the top without one)
+std::string InjectDefines(std::string_view source, std::string_view defines);
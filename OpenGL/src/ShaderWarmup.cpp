@@ -0,0 +1,251 @@
+#include "ShaderWarmup.h"
+#include "Renderer.h"
+
+#include <cstdio>
+#include <iostream>
+
+static double MsSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+static void SetCapability(GLenum capability, bool enabled)
+{
+    if (enabled)
+    {
+        GLCall(glEnable(capability));
+    }
+    else
+    {
+        GLCall(glDisable(capability));
+    }
+}
+
+bool ShaderWarmup::Create()
+{
+    //OffscreenTarget::Create() leaves framebuffer 0 bound, which a headless context doesn't have
+    int drawFramebuffer = 0, readFramebuffer = 0;
+    GLCall(glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &drawFramebuffer));
+    GLCall(glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &readFramebuffer));
+    //RGBA8, the same format the window and the headless target draw into
+    bool created = m_Target.Create(1, 1);
+    GLCall(glBindFramebuffer(GL_DRAW_FRAMEBUFFER, drawFramebuffer));
+    GLCall(glBindFramebuffer(GL_READ_FRAMEBUFFER, readFramebuffer));
+    if (!created)
+        return false;
+    GLCall(glGenVertexArrays(1, &m_EmptyVertexArray));
+    return true;
+}
+
+void ShaderWarmup::Destroy()
+{
+    m_Target.Destroy();
+    if (m_EmptyVertexArray)
+    {
+        GLCall(glDeleteVertexArrays(1, &m_EmptyVertexArray));
+        m_EmptyVertexArray = 0;
+    }
+    m_Entries.clear();
+    m_Next = 0;
+    m_FirstUse = -1;
+}
+
+void ShaderWarmup::Add(unsigned int program, const std::string& name, const WarmupState& state)
+{
+    if (!program || Find(program, false, state))
+        return;
+    Entry& entry = m_Entries.emplace_back();
+    entry.Program = program;
+    entry.Name = name;
+    entry.State = state;
+}
+
+void ShaderWarmup::AddPipeline(unsigned int pipeline, const std::string& name, const WarmupState& state)
+{
+    if (!pipeline || Find(pipeline, true, state))
+        return;
+    Entry& entry = m_Entries.emplace_back();
+    entry.Program = pipeline;
+    entry.IsPipeline = true;
+    entry.Name = name;
+    entry.State = state;
+}
+
+ShaderWarmup::Entry* ShaderWarmup::Find(unsigned int program, bool isPipeline, const WarmupState& state)
+{
+    for (Entry& entry : m_Entries)
+    {
+        if (entry.Program == program && entry.IsPipeline == isPipeline && entry.State == state)
+            return &entry;
+    }
+    return nullptr;
+}
+
+const ShaderWarmup::Entry* ShaderWarmup::Find(unsigned int program, bool isPipeline, const WarmupState& state) const
+{
+    return const_cast<ShaderWarmup*>(this)->Find(program, isPipeline, state);
+}
+
+bool ShaderWarmup::IsWarm(unsigned int program, const WarmupState& state, bool isPipeline) const
+{
+    const Entry* entry = Find(program, isPipeline, state);
+    return entry && entry->Warm;
+}
+
+void ShaderWarmup::Forget(unsigned int program, bool isPipeline)
+{
+    for (size_t index = m_Entries.size(); index-- > 0;)
+    {
+        const Entry& entry = m_Entries[index];
+        if (entry.Program != program || entry.IsPipeline != isPipeline)
+            continue;
+        m_Entries.erase(m_Entries.begin() + index);
+        if (index < m_Next)
+            m_Next--;
+        if (m_FirstUse == (int)index)
+            m_FirstUse = -1;
+        else if (m_FirstUse > (int)index)
+            m_FirstUse--;
+    }
+}
+
+void ShaderWarmup::Draw(const Entry& entry) const
+{
+    if (entry.IsPipeline)
+    {
+        GLCall(glUseProgram(0));
+        GLCall(glBindProgramPipeline(entry.Program));
+    }
+    else
+    {
+        GLCall(glUseProgram(entry.Program));
+    }
+    GLCall(glBindVertexArray(entry.State.VertexArray ? entry.State.VertexArray : m_EmptyVertexArray));
+    SetCapability(GL_BLEND, entry.State.Blend);
+    if (entry.State.Blend)
+    {
+        GLCall(glBlendFunc(entry.State.BlendSource, entry.State.BlendDestination));
+    }
+    SetCapability(GL_DEPTH_TEST, entry.State.DepthTest);
+    GLCall(glDrawArrays(entry.State.Primitive, 0, 3));
+    //the draw only counts as done once the GPU (and the driver's compile) is done
+    glFinish();
+}
+
+unsigned int ShaderWarmup::Run(double budgetMs)
+{
+    if (m_Next == m_Entries.size())
+        return 0;
+
+    //everything Draw() touches, so the caller's frame (and GLStateCache's mirror of it) carries on unchanged
+    int drawFramebuffer = 0, readFramebuffer = 0, viewport[4] = {}, program = 0, pipeline = 0, vertexArray = 0;
+    GLCall(glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &drawFramebuffer));
+    GLCall(glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &readFramebuffer));
+    GLCall(glGetIntegerv(GL_VIEWPORT, viewport));
+    GLCall(glGetIntegerv(GL_CURRENT_PROGRAM, &program));
+    bool separateShaderObjects = GLEW_VERSION_4_1 || GLEW_ARB_separate_shader_objects;
+    if (separateShaderObjects)
+    {
+        GLCall(glGetIntegerv(GL_PROGRAM_PIPELINE_BINDING, &pipeline));
+    }
+    GLCall(glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &vertexArray));
+    bool blend = glIsEnabled(GL_BLEND), depthTest = glIsEnabled(GL_DEPTH_TEST);
+    int blendFunc[4] = {};
+    GLCall(glGetIntegerv(GL_BLEND_SRC_RGB, &blendFunc[0]));
+    GLCall(glGetIntegerv(GL_BLEND_DST_RGB, &blendFunc[1]));
+    GLCall(glGetIntegerv(GL_BLEND_SRC_ALPHA, &blendFunc[2]));
+    GLCall(glGetIntegerv(GL_BLEND_DST_ALPHA, &blendFunc[3]));
+
+    m_Target.Bind();
+    auto start = std::chrono::steady_clock::now();
+    while (m_Next < m_Entries.size())
+    {
+        Entry& entry = m_Entries[m_Next++];
+        if (entry.Warm)
+            continue;
+
+        auto drawStart = std::chrono::steady_clock::now();
+        Draw(entry);
+        entry.WarmupMs = MsSince(drawStart);
+        drawStart = std::chrono::steady_clock::now();
+        Draw(entry);
+        entry.WarmMs = MsSince(drawStart);
+        entry.Warm = true;
+
+        if (budgetMs > 0.0 && MsSince(start) >= budgetMs)
+            break;
+    }
+
+    GLCall(glBindFramebuffer(GL_DRAW_FRAMEBUFFER, drawFramebuffer));
+    GLCall(glBindFramebuffer(GL_READ_FRAMEBUFFER, readFramebuffer));
+    GLCall(glViewport(viewport[0], viewport[1], viewport[2], viewport[3]));
+    //0 too, or a warmed pipeline would still be bound for the next draw with no program
+    if (separateShaderObjects)
+    {
+        GLCall(glBindProgramPipeline(pipeline));
+    }
+    GLCall(glUseProgram(program));
+    GLCall(glBindVertexArray(vertexArray));
+    SetCapability(GL_BLEND, blend);
+    GLCall(glBlendFuncSeparate(blendFunc[0], blendFunc[1], blendFunc[2], blendFunc[3]));
+    SetCapability(GL_DEPTH_TEST, depthTest);
+    return (unsigned int)(m_Entries.size() - m_Next);
+}
+
+void ShaderWarmup::BeginFirstUse(unsigned int program, const WarmupState& state, bool isPipeline)
+{
+    Entry* entry = Find(program, isPipeline, state);
+    if (!entry)
+    {
+        //never warmed, still worth knowing what its first draw cost
+        entry = &m_Entries.emplace_back();
+        entry->Program = program;
+        entry->IsPipeline = isPipeline;
+        entry->State = state;
+        entry->Name = "(not warmed)";
+        entry->Warm = true;
+    }
+    if (entry->SecondUseMs >= 0.0)
+        return;
+    m_FirstUse = (int)(entry - m_Entries.data());
+    m_FirstUseStart = std::chrono::steady_clock::now();
+}
+
+void ShaderWarmup::EndFirstUse()
+{
+    if (m_FirstUse < 0)
+        return;
+    glFinish();
+    Entry& entry = m_Entries[m_FirstUse];
+    (entry.FirstUseMs < 0.0 ? entry.FirstUseMs : entry.SecondUseMs) = MsSince(m_FirstUseStart);
+    m_FirstUse = -1;
+}
+
+void ShaderWarmup::PrintReport() const
+{
+    if (m_Entries.empty())
+        return;
+    //the warm-up draws are one triangle into one pixel, only the real draws compare to each other
+    std::cout << "[ShaderWarmup] warm-up first / second draw, real first / second draw" << std::endl;
+    unsigned int spikes = 0;
+    for (const Entry& entry : m_Entries)
+    {
+        bool spike = entry.SecondUseMs >= 0.0 && entry.FirstUseMs - entry.SecondUseMs > SpikeThresholdMs;
+        spikes += spike;
+
+        printf("  %-8s %4u %-24s", entry.IsPipeline ? "pipeline" : "program", entry.Program, entry.Name.c_str());
+        if (entry.WarmupMs >= 0.0)
+            printf(" %8.3f / %8.3f ms", entry.WarmupMs, entry.WarmMs);
+        else
+            printf(" %21s", "-");
+        if (entry.SecondUseMs >= 0.0)
+            printf(", %8.3f / %8.3f ms%s\n", entry.FirstUseMs, entry.SecondUseMs, spike ? "  still spiked" : "");
+        else if (entry.FirstUseMs >= 0.0)
+            printf(", %8.3f ms, drawn once\n", entry.FirstUseMs);
+        else
+            printf(", %21s\n", "unused");
+    }
+    if (spikes)
+        printf("  %u of %zu first draws were still over %.1f ms slower than the second\n",
+            spikes, m_Entries.size(), SpikeThresholdMs);
+}
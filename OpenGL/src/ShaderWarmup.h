@@ -0,0 +1,99 @@
+#pragma once
+#include "Headless.h"
+#include <GL/glew.h>
+#include <chrono>
+#include <string>
+#include <vector>
+
+//The state a program is going to be drawn with. Drivers compile the final
+//GPU code on the first draw and key it on some of this (blending, vertex
+//fetch, primitive type), so warming with different state warms the wrong thing.
+struct WarmupState
+{
+    unsigned int VertexArray = 0; //0 draws with no attributes enabled
+    GLenum Primitive = GL_TRIANGLES;
+    bool Blend = false;
+    //only used with Blend, some drivers bake the blend equation into the shader
+    GLenum BlendSource = GL_SRC_ALPHA;
+    GLenum BlendDestination = GL_ONE_MINUS_SRC_ALPHA;
+    bool DepthTest = false;
+
+    bool operator==(const WarmupState& other) const
+    {
+        return VertexArray == other.VertexArray && Primitive == other.Primitive && Blend == other.Blend
+            && (!Blend || (BlendSource == other.BlendSource && BlendDestination == other.BlendDestination))
+            && DepthTest == other.DepthTest;
+    }
+};
+
+//Gets a program's first-draw compile out of the way before a real frame pays for it.
+//
+//Add() queues a program (or a program pipeline) with the state it will be
+//drawn with, one entry per program and state, so a program drawn two ways
+//is warmed both ways. Run() then draws one triangle with each queued entry into a
+//1x1 framebuffer and waits for it, and draws it once more to see what a
+//warm draw costs. With a budget Run() stops once that many milliseconds are
+//spent, so a long list can be spread over a few frames; an entry IsWarm()
+//after its turn.
+//
+//BeginFirstUse()/EndFirstUse() go around the first real draws with a program.
+//PrintReport() lists every entry and flags the ones whose first real draw
+//was still much slower than the second, which means the driver compiled
+//again for state the warm-up didn't match. Main thread only.
+class ShaderWarmup
+{
+public:
+    //how much slower than the second real draw the first may be before it counts as a spike
+    static constexpr double SpikeThresholdMs = 1.0;
+
+    ShaderWarmup() = default;
+    ShaderWarmup(const ShaderWarmup&) = delete;
+    ShaderWarmup& operator=(const ShaderWarmup&) = delete;
+
+    //needs a current context
+    bool Create();
+    void Destroy();
+
+    void Add(unsigned int program, const std::string& name, const WarmupState& state = {});
+    void AddPipeline(unsigned int pipeline, const std::string& name, const WarmupState& state = {});
+
+    //warms queued entries, budgetMs <= 0 warms all of them.
+    //Returns how many are still waiting. GL state is put back the way it was
+    unsigned int Run(double budgetMs = 0.0);
+    //pipelines and programs are separate names, isPipeline says which one is meant
+    bool IsWarm(unsigned int program, const WarmupState& state = {}, bool isPipeline = false) const;
+    //drops every entry for the program, call it when the program is deleted. GL reuses
+    //names, so a later program with the same one would otherwise count as already warm
+    void Forget(unsigned int program, bool isPipeline = false);
+
+    //a draw with program goes between these, End waits for the GPU.
+    //Only the first two per program are timed, after that they do nothing
+    void BeginFirstUse(unsigned int program, const WarmupState& state = {}, bool isPipeline = false);
+    void EndFirstUse();
+
+    void PrintReport() const;
+private:
+    struct Entry
+    {
+        unsigned int Program = 0;
+        bool IsPipeline = false;
+        std::string Name;
+        WarmupState State;
+        bool Warm = false;
+        double WarmupMs = -1.0; //first draw during warm-up, -1 if it never had one
+        double WarmMs = 0.0;    //the draw right after it
+        double FirstUseMs = -1.0;
+        double SecondUseMs = -1.0;
+    };
+
+    Entry* Find(unsigned int program, bool isPipeline, const WarmupState& state);
+    const Entry* Find(unsigned int program, bool isPipeline, const WarmupState& state) const;
+    void Draw(const Entry& entry) const;
+
+    OffscreenTarget m_Target;
+    unsigned int m_EmptyVertexArray = 0;
+    std::vector<Entry> m_Entries;
+    size_t m_Next = 0; //entries before this one have been warmed
+    int m_FirstUse = -1; //index of the entry between BeginFirstUse and EndFirstUse
+    std::chrono::steady_clock::time_point m_FirstUseStart;
+};
@@ -0,0 +1,361 @@
+#include "SoftwareRasterizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define RASTERIZER_SSE2 1
+#endif
+
+static uint32_t PackColor(float r, float g, float b, float a)
+{
+    //the same float -> unorm8 conversion GL does when writing to an RGBA8 target
+    auto unorm = [](float c) { return (uint32_t)(std::min(std::max(c, 0.0f), 1.0f) * 255.0f + 0.5f); };
+    return unorm(r) | (unorm(g) << 8) | (unorm(b) << 16) | (unorm(a) << 24);
+}
+
+SoftwareRasterizer::SoftwareRasterizer(int width, int height, unsigned int threadCount)
+    : m_Width(width), m_Height(height)
+{
+    m_Stride = (width + 3) & ~3;
+    m_TilesX = (width + TileSize - 1) / TileSize;
+    m_TilesY = (height + TileSize - 1) / TileSize;
+    m_ColorBuffer.resize((size_t)m_Stride * height);
+
+    if (threadCount == 0)
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    m_Bins.resize((size_t)threadCount * m_TilesX * m_TilesY);
+
+    //the calling thread is worker 0
+    for (unsigned int i = 1; i < threadCount; i++)
+        m_Workers.emplace_back(&SoftwareRasterizer::WorkerLoop, this, i);
+}
+
+SoftwareRasterizer::~SoftwareRasterizer()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_JobMutex);
+        m_Quit = true;
+    }
+    m_JobReady.notify_all();
+    for (std::thread& worker : m_Workers)
+        worker.join();
+}
+
+void SoftwareRasterizer::RunParallel(const std::function<void(unsigned int)>& job)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_JobMutex);
+        m_Job = &job;
+        m_JobsRemaining = (unsigned int)m_Workers.size();
+        m_JobGeneration++;
+    }
+    m_JobReady.notify_all();
+
+    job(0);
+
+    std::unique_lock<std::mutex> lock(m_JobMutex);
+    m_JobDone.wait(lock, [this] { return m_JobsRemaining == 0; });
+    m_Job = nullptr;
+}
+
+void SoftwareRasterizer::WorkerLoop(unsigned int worker)
+{
+    uint64_t seenGeneration = 0;
+    while (true)
+    {
+        const std::function<void(unsigned int)>* job;
+        {
+            std::unique_lock<std::mutex> lock(m_JobMutex);
+            m_JobReady.wait(lock, [&] { return m_Quit || m_JobGeneration != seenGeneration; });
+            if (m_Quit)
+                return;
+            seenGeneration = m_JobGeneration;
+            job = m_Job;
+        }
+
+        (*job)(worker);
+
+        std::lock_guard<std::mutex> lock(m_JobMutex);
+        if (--m_JobsRemaining == 0)
+            m_JobDone.notify_one();
+    }
+}
+
+void SoftwareRasterizer::BufferData(GLenum target, size_t size, const void* data)
+{
+    if (target == GL_ARRAY_BUFFER)
+    {
+        m_VertexData = (const unsigned char*)data;
+        m_VertexDataSize = size;
+    }
+    else if (target == GL_ELEMENT_ARRAY_BUFFER)
+    {
+        m_IndexData = (const unsigned char*)data;
+        m_IndexDataSize = size;
+    }
+}
+
+void SoftwareRasterizer::VertexAttribPointer(unsigned int index, int size, GLenum type, bool /*normalized*/, int stride, size_t offset)
+{
+    if (index != 0)
+        return;
+    if (type != GL_FLOAT || size < 1 || size > 4 || stride < 0)
+    {
+        std::cout << "[SoftwareRasterizer] Only GL_FLOAT positions with 1-4 components and a stride of 0 or more are supported" << std::endl;
+        return;
+    }
+    m_PositionSize = size;
+    //a stride of 0 means tightly packed, same as in GL
+    m_PositionStride = stride ? stride : size * (int)sizeof(float);
+    m_PositionOffset = offset;
+}
+
+void SoftwareRasterizer::Uniform4f(float r, float g, float b, float a)
+{
+    m_Color = PackColor(r, g, b, a);
+}
+
+void SoftwareRasterizer::ClearColor(float r, float g, float b, float a)
+{
+    m_ClearColor = PackColor(r, g, b, a);
+}
+
+void SoftwareRasterizer::Clear()
+{
+    std::fill(m_ColorBuffer.begin(), m_ColorBuffer.end(), m_ClearColor);
+}
+
+unsigned int SoftwareRasterizer::FetchIndex(GLenum type, size_t offset, int i) const
+{
+    if (type == GL_UNSIGNED_SHORT)
+    {
+        uint16_t index;
+        memcpy(&index, m_IndexData + offset + (size_t)i * sizeof(index), sizeof(index));
+        return index;
+    }
+    uint32_t index;
+    memcpy(&index, m_IndexData + offset + (size_t)i * sizeof(index), sizeof(index));
+    return index;
+}
+
+void SoftwareRasterizer::DrawElements(GLenum mode, int count, GLenum type, size_t offset)
+{
+    if (mode != GL_TRIANGLES || (type != GL_UNSIGNED_INT && type != GL_UNSIGNED_SHORT))
+    {
+        std::cout << "[SoftwareRasterizer] Only GL_TRIANGLES with GL_UNSIGNED_INT/GL_UNSIGNED_SHORT indices are supported" << std::endl;
+        return;
+    }
+    size_t indexSize = type == GL_UNSIGNED_SHORT ? 2 : 4;
+    if (!m_IndexData || offset + (size_t)count * indexSize > m_IndexDataSize)
+    {
+        std::cout << "[SoftwareRasterizer] Draw reads past the end of the index buffer" << std::endl;
+        return;
+    }
+
+    size_t attribBytes = (size_t)m_PositionSize * sizeof(float);
+    size_t vertexCount = 0;
+    if (m_VertexData && m_PositionStride > 0 && m_VertexDataSize >= m_PositionOffset + attribBytes)
+        vertexCount = (m_VertexDataSize - m_PositionOffset - attribBytes) / m_PositionStride + 1;
+
+    int triangleCount = count / 3;
+    m_Vertices.resize(vertexCount);
+    m_Triangles.resize(triangleCount);
+
+    RunParallel([&](unsigned int worker) { TransformVertices(worker, vertexCount); });
+    RunParallel([&](unsigned int worker) { SetupAndBin(worker, type, offset, triangleCount); });
+    m_NextTile = 0;
+    RunParallel([&](unsigned int) { RasterizeTiles(); });
+}
+
+void SoftwareRasterizer::TransformVertices(unsigned int worker, size_t vertexCount)
+{
+    size_t threads = GetThreadCount();
+    size_t begin = vertexCount * worker / threads;
+    size_t end = vertexCount * (worker + 1) / threads;
+
+    for (size_t i = begin; i < end; i++)
+    {
+        //missing components default to (0, 0, 0, 1) like any vertex attribute
+        float position[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+        memcpy(position, m_VertexData + m_PositionOffset + i * m_PositionStride, m_PositionSize * sizeof(float));
+
+        ScreenVertex& vertex = m_Vertices[i];
+        vertex.Valid = position[3] > 0.0f;
+        if (!vertex.Valid)
+            continue;
+
+        //Basic.shader passes the position straight through, so this is just
+        //the perspective divide and the viewport transform. Snapping to 1/256th
+        //of a pixel keeps shared edges bit-identical between triangles.
+        float x = (position[0] / position[3] + 1.0f) * 0.5f * m_Width;
+        float y = (position[1] / position[3] + 1.0f) * 0.5f * m_Height;
+        vertex.X = std::round(x * 256.0f) / 256.0f;
+        vertex.Y = std::round(y * 256.0f) / 256.0f;
+    }
+}
+
+void SoftwareRasterizer::SetupAndBin(unsigned int worker, GLenum type, size_t offset, int triangleCount)
+{
+    int tileCount = m_TilesX * m_TilesY;
+    std::vector<uint32_t>* bins = &m_Bins[(size_t)worker * tileCount];
+    for (int tile = 0; tile < tileCount; tile++)
+        bins[tile].clear();
+
+    size_t threads = GetThreadCount();
+    int begin = (int)((size_t)triangleCount * worker / threads);
+    int end = (int)((size_t)triangleCount * (worker + 1) / threads);
+
+    for (int t = begin; t < end; t++)
+    {
+        Triangle& tri = m_Triangles[t];
+        unsigned int index[3];
+        bool valid = true;
+        for (int i = 0; i < 3; i++)
+        {
+            index[i] = FetchIndex(type, offset, t * 3 + i);
+            valid = valid && index[i] < m_Vertices.size() && m_Vertices[index[i]].Valid;
+        }
+        if (!valid)
+            continue;
+
+        const ScreenVertex* v[3] = { &m_Vertices[index[0]], &m_Vertices[index[1]], &m_Vertices[index[2]] };
+        float area = (v[1]->X - v[0]->X) * (v[2]->Y - v[0]->Y) - (v[2]->X - v[0]->X) * (v[1]->Y - v[0]->Y);
+        if (area == 0.0f)
+            continue;
+        //there is no face culling, clockwise triangles are flipped so the edge
+        //functions are positive inside no matter the winding
+        if (area < 0.0f)
+            std::swap(v[1], v[2]);
+
+        for (int e = 0; e < 3; e++)
+        {
+            const ScreenVertex& a = *v[e];
+            const ScreenVertex& b = *v[(e + 1) % 3];
+            tri.A[e] = a.Y - b.Y;
+            tri.B[e] = b.X - a.X;
+            tri.C[e] = -(tri.A[e] * a.X + tri.B[e] * a.Y);
+            //left edges and horizontal top edges own the pixels that fall exactly on them
+            tri.Inclusive[e] = tri.A[e] > 0.0f || (tri.A[e] == 0.0f && tri.B[e] < 0.0f);
+        }
+
+        //pixel centers are at +0.5, so these bounds cover every center the triangle can touch
+        float minX = std::min({ v[0]->X, v[1]->X, v[2]->X });
+        float maxX = std::max({ v[0]->X, v[1]->X, v[2]->X });
+        float minY = std::min({ v[0]->Y, v[1]->Y, v[2]->Y });
+        float maxY = std::max({ v[0]->Y, v[1]->Y, v[2]->Y });
+        tri.MinX = std::max(0, (int)std::floor(minX - 0.5f));
+        tri.MinY = std::max(0, (int)std::floor(minY - 0.5f));
+        tri.MaxX = std::min(m_Width - 1, (int)std::ceil(maxX - 0.5f));
+        tri.MaxY = std::min(m_Height - 1, (int)std::ceil(maxY - 0.5f));
+        if (tri.MinX > tri.MaxX || tri.MinY > tri.MaxY)
+            continue;
+
+        for (int ty = tri.MinY / TileSize; ty <= tri.MaxY / TileSize; ty++)
+            for (int tx = tri.MinX / TileSize; tx <= tri.MaxX / TileSize; tx++)
+                bins[ty * m_TilesX + tx].push_back((uint32_t)t);
+    }
+}
+
+void SoftwareRasterizer::RasterizeTiles()
+{
+    int tileCount = m_TilesX * m_TilesY;
+    unsigned int threads = GetThreadCount();
+    for (int tile = m_NextTile++; tile < tileCount; tile = m_NextTile++)
+    {
+        int tileX0 = (tile % m_TilesX) * TileSize;
+        int tileY0 = (tile / m_TilesX) * TileSize;
+        int tileX1 = std::min(tileX0 + TileSize, m_Width) - 1;
+        int tileY1 = std::min(tileY0 + TileSize, m_Height) - 1;
+
+        //worker bins hold consecutive triangle ranges, so walking them in
+        //worker order keeps the later-triangle-wins order of the draw
+        for (unsigned int worker = 0; worker < threads; worker++)
+            for (uint32_t t : m_Bins[(size_t)worker * tileCount + tile])
+                RasterizeTriangle(m_Triangles[t], tileX0, tileY0, tileX1, tileY1);
+    }
+}
+
+void SoftwareRasterizer::RasterizeTriangle(const Triangle& tri, int tileX0, int tileY0, int tileX1, int tileY1)
+{
+    int xStart = std::max(tri.MinX, tileX0);
+    int xEnd = std::min(tri.MaxX, tileX1);
+    int yStart = std::max(tri.MinY, tileY0);
+    int yEnd = std::min(tri.MaxY, tileY1);
+    //tiles start on a multiple of 4 so the aligned start never leaves the tile,
+    //and the row stride is padded so the last group of 4 never leaves the row
+    int xAligned = xStart & ~3;
+
+#ifdef RASTERIZER_SSE2
+    const __m128 laneOffset = _mm_set_ps(3.5f, 2.5f, 1.5f, 0.5f);
+    const __m128i laneIndex = _mm_set_epi32(3, 2, 1, 0);
+    const __m128i color = _mm_set1_epi32((int)m_Color);
+    const __m128 zero = _mm_setzero_ps();
+    __m128 A[3];
+    for (int e = 0; e < 3; e++)
+        A[e] = _mm_set1_ps(tri.A[e]);
+
+    for (int y = yStart; y <= yEnd; y++)
+    {
+        float yCenter = y + 0.5f;
+        __m128 rowBase[3];
+        for (int e = 0; e < 3; e++)
+            rowBase[e] = _mm_set1_ps(tri.B[e] * yCenter + tri.C[e]);
+
+        uint32_t* row = &m_ColorBuffer[(size_t)y * m_Stride];
+        for (int x = xAligned; x <= xEnd; x += 4)
+        {
+            __m128 xs = _mm_add_ps(_mm_set1_ps((float)x), laneOffset);
+            __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+            for (int e = 0; e < 3; e++)
+            {
+                __m128 value = _mm_add_ps(_mm_mul_ps(A[e], xs), rowBase[e]);
+                inside = _mm_and_ps(inside, tri.Inclusive[e] ? _mm_cmpge_ps(value, zero) : _mm_cmpgt_ps(value, zero));
+            }
+
+            //drop the lanes that are outside this tile or the triangle bounds
+            __m128i lane = _mm_add_epi32(_mm_set1_epi32(x), laneIndex);
+            __m128i inRange = _mm_andnot_si128(
+                _mm_or_si128(_mm_cmplt_epi32(lane, _mm_set1_epi32(xStart)), _mm_cmpgt_epi32(lane, _mm_set1_epi32(xEnd))),
+                _mm_set1_epi32(-1));
+            __m128i mask = _mm_and_si128(_mm_castps_si128(inside), inRange);
+            if (_mm_movemask_epi8(mask) == 0)
+                continue;
+
+            __m128i* dst = (__m128i*)(row + x);
+            __m128i pixels = _mm_loadu_si128(dst);
+            pixels = _mm_or_si128(_mm_and_si128(mask, color), _mm_andnot_si128(mask, pixels));
+            _mm_storeu_si128(dst, pixels);
+        }
+    }
+#else
+    (void)xAligned;
+    for (int y = yStart; y <= yEnd; y++)
+    {
+        float yCenter = y + 0.5f;
+        uint32_t* row = &m_ColorBuffer[(size_t)y * m_Stride];
+        for (int x = xStart; x <= xEnd; x++)
+        {
+            float xCenter = x + 0.5f;
+            bool inside = true;
+            for (int e = 0; e < 3 && inside; e++)
+            {
+                float value = tri.A[e] * xCenter + tri.B[e] * yCenter + tri.C[e];
+                inside = tri.Inclusive[e] ? value >= 0.0f : value > 0.0f;
+            }
+            if (inside)
+                row[x] = m_Color;
+        }
+    }
+#endif
+}
+
+void SoftwareRasterizer::ReadPixels(std::vector<unsigned char>& pixels) const
+{
+    pixels.resize((size_t)m_Width * m_Height * 4);
+    for (int y = 0; y < m_Height; y++)
+        memcpy(&pixels[(size_t)y * m_Width * 4], &m_ColorBuffer[(size_t)y * m_Stride], (size_t)m_Width * 4);
+}
@@ -0,0 +1,111 @@
+#pragma once
+#include <GL/glew.h>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//A CPU implementation of the one draw path main() uses:
+//  glVertexAttribPointer(0, 2, GL_FLOAT, ...) + glUniform4f(u_Color) + glDrawElements(GL_TRIANGLES, ...)
+//so it can be exercised and timed on machines without a GPU.
+//
+//The function names mirror the GL calls on purpose, it consumes the exact
+//positions/indices arrays and attribute layout that get uploaded to the GPU.
+//Only attribute 0 (Basic.shader's position) is read and the fragment stage is
+//Basic.shader's flat color = u_Color. There is no clipper, triangles with a
+//vertex at w <= 0 are dropped.
+//
+//Work is split in three parallel phases, all on a pool with one thread per core:
+//  1. vertices are transformed to window coordinates
+//  2. triangles are set up and binned into 64x64 pixel tiles, each worker owning a
+//     contiguous range of triangles so bins stay in submission order
+//  3. workers pull whole tiles and walk the binned triangles with SSE2 edge functions,
+//     4 pixels at a time, so no two threads ever write the same pixel
+class SoftwareRasterizer
+{
+public:
+    static const int TileSize = 64;
+
+    //threadCount of 0 means one worker per hardware thread
+    SoftwareRasterizer(int width, int height, unsigned int threadCount = 0);
+    ~SoftwareRasterizer();
+
+    SoftwareRasterizer(const SoftwareRasterizer&) = delete;
+    SoftwareRasterizer& operator=(const SoftwareRasterizer&) = delete;
+
+    //the data is not copied, like a mapped buffer it must outlive the draws
+    void BufferData(GLenum target, size_t size, const void* data);
+    //same meaning as the GL call, only GL_FLOAT attribute 0 is used,
+    //so normalized is ignored like GL ignores it for floats
+    void VertexAttribPointer(unsigned int index, int size, GLenum type, bool normalized, int stride, size_t offset);
+    void Uniform4f(float r, float g, float b, float a);
+    void ClearColor(float r, float g, float b, float a);
+    void Clear();
+    //mode must be GL_TRIANGLES, type GL_UNSIGNED_INT or GL_UNSIGNED_SHORT,
+    //offset is a byte offset into the index buffer like the GL pointer argument
+    void DrawElements(GLenum mode, int count, GLenum type, size_t offset);
+
+    //RGBA8, bottom row first, the same layout glReadPixels(GL_RGBA, GL_UNSIGNED_BYTE) gives
+    void ReadPixels(std::vector<unsigned char>& pixels) const;
+
+    int GetWidth() const { return m_Width; }
+    int GetHeight() const { return m_Height; }
+    unsigned int GetThreadCount() const { return (unsigned int)m_Workers.size() + 1; }
+private:
+    struct ScreenVertex
+    {
+        float X, Y;
+        bool Valid;
+    };
+
+    //edge function E(x,y) = A*x + B*y + C, positive inside a counter-clockwise triangle
+    struct Triangle
+    {
+        float A[3], B[3], C[3];
+        bool Inclusive[3]; //top-left fill rule, so shared edges are drawn exactly once
+        int MinX, MinY, MaxX, MaxY; //inclusive pixel bounds, already clipped to the screen
+    };
+
+    void RunParallel(const std::function<void(unsigned int)>& job);
+    void WorkerLoop(unsigned int worker);
+
+    unsigned int FetchIndex(GLenum type, size_t offset, int i) const;
+    void TransformVertices(unsigned int worker, size_t vertexCount);
+    void SetupAndBin(unsigned int worker, GLenum type, size_t offset, int triangleCount);
+    void RasterizeTiles();
+    void RasterizeTriangle(const Triangle& tri, int tileX0, int tileY0, int tileX1, int tileY1);
+
+    int m_Width, m_Height;
+    int m_Stride; //pixels per row, padded to a multiple of 4 for the SIMD stores
+    int m_TilesX, m_TilesY;
+    std::vector<uint32_t> m_ColorBuffer;
+    uint32_t m_ClearColor = 0;
+    uint32_t m_Color = 0xffffffff;
+
+    const unsigned char* m_VertexData = nullptr;
+    size_t m_VertexDataSize = 0;
+    const unsigned char* m_IndexData = nullptr;
+    size_t m_IndexDataSize = 0;
+    int m_PositionSize = 4;
+    int m_PositionStride = 4 * sizeof(float); //tightly packed until VertexAttribPointer() says otherwise
+    size_t m_PositionOffset = 0;
+
+    std::vector<ScreenVertex> m_Vertices;
+    std::vector<Triangle> m_Triangles;
+    //m_Bins[worker * tileCount + tile] holds triangle indices in submission order
+    std::vector<std::vector<uint32_t>> m_Bins;
+    std::atomic<int> m_NextTile{ 0 };
+
+    std::vector<std::thread> m_Workers;
+    std::mutex m_JobMutex;
+    std::condition_variable m_JobReady;
+    std::condition_variable m_JobDone;
+    const std::function<void(unsigned int)>* m_Job = nullptr;
+    uint64_t m_JobGeneration = 0;
+    unsigned int m_JobsRemaining = 0;
+    bool m_Quit = false;
+};
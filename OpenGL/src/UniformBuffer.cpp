@@ -0,0 +1,56 @@
+#include "UniformBuffer.h"
+#include "GLStateCache.h"
+#include "Renderer.h"
+
+#include <cstring>
+
+void UniformBuffer::Create(unsigned int capacity)
+{
+    int alignment = 0;
+    GLCall(glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment));
+    if (alignment > 0)
+        m_OffsetAlignment = (unsigned int)alignment;
+
+    m_Capacity = capacity;
+    m_Staging.reserve(capacity);
+    GLCall(glGenBuffers(1, &m_RendererID));
+    GLStateCache::Get().BindBuffer(GL_UNIFORM_BUFFER, m_RendererID);
+    GLCall(glBufferData(GL_UNIFORM_BUFFER, capacity, nullptr, GL_STREAM_DRAW));
+}
+
+void UniformBuffer::Destroy()
+{
+    if (m_RendererID)
+    {
+        GLStateCache::Get().ForgetBuffer(m_RendererID);
+        GLCall(glDeleteBuffers(1, &m_RendererID));
+    }
+    m_RendererID = 0;
+    m_Staging.clear();
+}
+
+unsigned int UniformBuffer::Push(const void* data, unsigned int size)
+{
+    unsigned int offset = (unsigned int)AlignUp(m_Staging.size(), m_OffsetAlignment);
+    ASSERT(offset + size <= m_Capacity);
+    m_Staging.resize(offset + size);
+    memcpy(&m_Staging[offset], data, size);
+    return offset;
+}
+
+void UniformBuffer::Upload()
+{
+    if (m_Staging.empty())
+        return;
+    GLStateCache::Get().BindBuffer(GL_UNIFORM_BUFFER, m_RendererID);
+    //orphan: a fresh allocation instead of overwriting storage a draw may still read
+    GLCall(glBufferData(GL_UNIFORM_BUFFER, m_Capacity, nullptr, GL_STREAM_DRAW));
+    GLCall(glBufferSubData(GL_UNIFORM_BUFFER, 0, m_Staging.size(), m_Staging.data()));
+    m_Staging.clear();
+}
+
+void UniformBuffer::BindRange(unsigned int binding, unsigned int offset, unsigned int size) const
+{
+    //the same range as last frame (the usual case, offsets start over every Upload()) is skipped
+    GLStateCache::Get().BindBufferRange(GL_UNIFORM_BUFFER, binding, m_RendererID, offset, size);
+}
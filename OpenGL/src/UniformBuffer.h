@@ -0,0 +1,123 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <vector>
+
+//C++ types for the members of a std140 uniform block. alignas makes the
+//compiler lay a struct out the way std140 does for the common cases, and
+//STD140_CHECK_MEMBER proves it for each member at compile time. What it
+//can't line up on its own (a vec3 after a scalar, arrays of scalars, which
+//std140 pads to a vec4 per element) fails to compile instead of rendering garbage.
+namespace std140
+{
+    struct alignas(8) vec2 { float x, y; };
+    //12 bytes and not aligned, so a float right after it packs into the 4th slot like std140 does
+    struct vec3 { float x, y, z; };
+    struct alignas(16) vec4 { float x, y, z, w; };
+    struct alignas(16) mat4 { vec4 Columns[4]; };
+}
+
+//Base alignment and size of a member under std140 rules (GL 4.6 spec 7.6.2.2)
+template<typename T> struct Std140Traits;
+template<> struct Std140Traits<float> { static constexpr size_t Align = 4, Size = 4; };
+template<> struct Std140Traits<int> { static constexpr size_t Align = 4, Size = 4; };
+template<> struct Std140Traits<unsigned int> { static constexpr size_t Align = 4, Size = 4; };
+template<> struct Std140Traits<std140::vec2> { static constexpr size_t Align = 8, Size = 8; };
+//a vec3 is 12 bytes, a scalar may sit in its last 4
+template<> struct Std140Traits<std140::vec3> { static constexpr size_t Align = 16, Size = 12; };
+template<> struct Std140Traits<std140::vec4> { static constexpr size_t Align = 16, Size = 16; };
+template<> struct Std140Traits<std140::mat4> { static constexpr size_t Align = 16, Size = 64; };
+
+constexpr size_t AlignUp(size_t value, size_t alignment)
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+//array elements are each rounded up to a vec4. The array is aligned like
+//its element rounded up to a vec4, not to the stride: a mat4[2] starts on 16
+template<typename T, size_t N> struct Std140Traits<T[N]>
+{
+    static constexpr size_t Stride = AlignUp(Std140Traits<T>::Size, 16);
+    static constexpr size_t Align = AlignUp(Std140Traits<T>::Align, 16), Size = Stride * N;
+};
+
+//Offsets of the members of a block, in declaration order, and the block's size,
+//all computed by the compiler:
+//  uniform Light { vec3 Position; float Radius; vec4 Color; };
+//  Std140Layout<std140::vec3, float, std140::vec4>::Offsets == { 0, 12, 16 }
+template<typename... Members>
+struct Std140Layout
+{
+    static constexpr size_t Count = sizeof...(Members);
+
+    struct Result
+    {
+        std::array<size_t, Count> Offsets;
+        size_t End;
+    };
+    static constexpr Result Compute()
+    {
+        Result result{};
+        size_t aligns[] = { Std140Traits<Members>::Align... };
+        size_t sizes[] = { Std140Traits<Members>::Size... };
+        size_t offset = 0;
+        for (size_t i = 0; i < Count; i++)
+        {
+            offset = AlignUp(offset, aligns[i]);
+            result.Offsets[i] = offset;
+            offset += sizes[i];
+        }
+        result.End = offset;
+        return result;
+    }
+
+    static constexpr std::array<size_t, Count> Offsets = Compute().Offsets;
+    //the block is padded to a multiple of a vec4
+    static constexpr size_t Size = AlignUp(Compute().End, 16);
+};
+
+//Put after a block struct that has a `using Layout = Std140Layout<...>`,
+//one check per member plus one for the size
+#define STD140_CHECK_MEMBER(Block, index, member) \
+    static_assert(offsetof(Block, member) == Block::Layout::Offsets[index], #Block "::" #member " is not at its std140 offset")
+#define STD140_CHECK_SIZE(Block) \
+    static_assert(sizeof(Block) == Block::Layout::Size, #Block " is not the size of its std140 block")
+
+//One GL uniform buffer that a frame's worth of blocks is packed into.
+//
+//Push() copies a block into a CPU side staging area and returns its offset,
+//Upload() sends everything pushed since the last Upload() with a single
+//glBufferSubData (after orphaning the buffer, so the driver doesn't wait on
+//draws still reading last frame's data), then BindRange() points a block
+//binding at one of the offsets for each draw.
+class UniformBuffer
+{
+public:
+    UniformBuffer() = default;
+    UniformBuffer(const UniformBuffer&) = delete;
+    UniformBuffer& operator=(const UniformBuffer&) = delete;
+
+    //capacity is bytes per frame, needs a current context
+    void Create(unsigned int capacity);
+    //not done by a destructor, the context may already be gone by then
+    void Destroy();
+
+    //returns the offset to give BindRange(), aligned to GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT
+    unsigned int Push(const void* data, unsigned int size);
+    template<typename Block>
+    unsigned int Push(const Block& block)
+    {
+        static_assert(sizeof(Block) == Block::Layout::Size, "push a block struct checked with STD140_CHECK_SIZE");
+        return Push(&block, (unsigned int)sizeof(Block));
+    }
+
+    void Upload();
+    void BindRange(unsigned int binding, unsigned int offset, unsigned int size) const;
+
+    unsigned int GetRendererID() const { return m_RendererID; }
+private:
+    unsigned int m_RendererID = 0;
+    unsigned int m_Capacity = 0;
+    unsigned int m_OffsetAlignment = 256;
+    std::vector<unsigned char> m_Staging;
+};
@@ -0,0 +1,174 @@
+#include "UniformState.h"
+#include "Renderer.h"
+
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <unordered_map>
+
+UniformState::Counters UniformState::s_Frame;
+UniformState::Counters UniformState::s_Total;
+unsigned int UniformState::s_Frames = 0;
+
+//bytes one element of a uniform of this type takes in the shadow
+static unsigned int UniformElementSize(unsigned int type)
+{
+    switch (type)
+    {
+    case GL_FLOAT_VEC2: case GL_INT_VEC2: case GL_UNSIGNED_INT_VEC2: case GL_BOOL_VEC2: return 8;
+    case GL_FLOAT_VEC3: case GL_INT_VEC3: case GL_UNSIGNED_INT_VEC3: case GL_BOOL_VEC3: return 12;
+    case GL_FLOAT_VEC4: case GL_INT_VEC4: case GL_UNSIGNED_INT_VEC4: case GL_BOOL_VEC4: return 16;
+    case GL_FLOAT_MAT2: return 16;
+    case GL_FLOAT_MAT3: return 36;
+    case GL_FLOAT_MAT4: return 64;
+    case GL_FLOAT_MAT2x3: case GL_FLOAT_MAT3x2: return 24;
+    case GL_FLOAT_MAT2x4: case GL_FLOAT_MAT4x2: return 32;
+    case GL_FLOAT_MAT3x4: case GL_FLOAT_MAT4x3: return 48;
+    case GL_DOUBLE: return 8;
+    default: return 4; //float, int, uint, bool and every sampler
+    }
+}
+
+UniformState::UniformState(const ProgramReflection& reflection)
+{
+    unsigned int offset = 0;
+    for (const UniformHandle& uniform : reflection.GetUniforms())
+    {
+        if (uniform.Location >= (int)m_SlotByLocation.size())
+            m_SlotByLocation.resize(uniform.Location + 1, -1);
+        m_SlotByLocation[uniform.Location] = (int)m_Slots.size();
+
+        Slot slot;
+        slot.Offset = offset;
+        slot.Size = UniformElementSize(uniform.Type) * uniform.Count;
+        m_Slots.push_back(slot);
+        offset += slot.Size;
+    }
+    m_Values.resize(offset);
+}
+
+bool UniformState::Changed(const UniformHandle& uniform, const void* data, unsigned int size)
+{
+    //an inactive uniform (-1) is a no-op for glUniform* too
+    if (uniform.Location < 0 || uniform.Location >= (int)m_SlotByLocation.size() || m_SlotByLocation[uniform.Location] < 0)
+    {
+        s_Frame.Skipped++;
+        return false;
+    }
+
+    Slot& slot = m_Slots[m_SlotByLocation[uniform.Location]];
+    ASSERT(size <= slot.Size);
+    unsigned char* shadow = &m_Values[slot.Offset];
+    //compares bits, not floats, so -0.0 vs 0.0 still uploads and a NaN that stays NaN doesn't
+    if (slot.Known && memcmp(shadow, data, size) == 0)
+    {
+        s_Frame.Skipped++;
+        return false;
+    }
+    memcpy(shadow, data, size);
+    slot.Known = true;
+    s_Frame.Issued++;
+    return true;
+}
+
+void UniformState::Set1i(const UniformHandle& uniform, int value)
+{
+    if (Changed(uniform, &value, sizeof(value)))
+    {
+        GLCall(glUniform1i(uniform.Location, value));
+    }
+}
+
+void UniformState::Set1iv(const UniformHandle& uniform, int count, const int* values)
+{
+    if (Changed(uniform, values, sizeof(int) * count))
+    {
+        GLCall(glUniform1iv(uniform.Location, count, values));
+    }
+}
+
+void UniformState::Set1f(const UniformHandle& uniform, float value)
+{
+    if (Changed(uniform, &value, sizeof(value)))
+    {
+        GLCall(glUniform1f(uniform.Location, value));
+    }
+}
+
+void UniformState::Set2f(const UniformHandle& uniform, float x, float y)
+{
+    float values[] = { x, y };
+    if (Changed(uniform, values, sizeof(values)))
+    {
+        GLCall(glUniform2f(uniform.Location, x, y));
+    }
+}
+
+void UniformState::Set3f(const UniformHandle& uniform, float x, float y, float z)
+{
+    float values[] = { x, y, z };
+    if (Changed(uniform, values, sizeof(values)))
+    {
+        GLCall(glUniform3f(uniform.Location, x, y, z));
+    }
+}
+
+void UniformState::Set4f(const UniformHandle& uniform, float x, float y, float z, float w)
+{
+    float values[] = { x, y, z, w };
+    if (Changed(uniform, values, sizeof(values)))
+    {
+        GLCall(glUniform4f(uniform.Location, x, y, z, w));
+    }
+}
+
+void UniformState::SetMatrix4fv(const UniformHandle& uniform, int count, const float* values)
+{
+    if (Changed(uniform, values, sizeof(float) * 16 * count))
+    {
+        GLCall(glUniformMatrix4fv(uniform.Location, count, GL_FALSE, values));
+    }
+}
+
+void UniformState::Invalidate()
+{
+    for (Slot& slot : m_Slots)
+        slot.Known = false;
+}
+
+void UniformState::EndFrame()
+{
+    s_Total.Issued += s_Frame.Issued;
+    s_Total.Skipped += s_Frame.Skipped;
+    s_Frame = Counters();
+    s_Frames++;
+}
+
+void UniformState::PrintStats()
+{
+    uint64_t total = s_Total.Issued + s_Total.Skipped;
+    if (s_Frames == 0 || total == 0)
+        return;
+    std::cout << "[UniformState] " << (double)s_Total.Issued / s_Frames << " uploads issued, "
+        << (double)s_Total.Skipped / s_Frames << " skipped per frame over " << s_Frames << " frames";
+    std::cout << " (" << 100.0 * s_Total.Skipped / total << "% skipped)" << std::endl;
+}
+
+//render thread only like the rest of UniformState, so no lock unlike the reflections
+static std::unordered_map<unsigned int, std::unique_ptr<UniformState>> s_States;
+
+UniformState* GetUniformState(unsigned int program)
+{
+    auto it = s_States.find(program);
+    if (it != s_States.end())
+        return it->second.get();
+    const ProgramReflection* reflection = GetProgramReflection(program);
+    if (!reflection)
+        return nullptr;
+    return (s_States[program] = std::make_unique<UniformState>(*reflection)).get();
+}
+
+void ForgetUniformState(unsigned int program)
+{
+    s_States.erase(program);
+}
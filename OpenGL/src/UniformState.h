@@ -0,0 +1,68 @@
+#pragma once
+#include "ShaderReflection.h"
+#include <cstdint>
+#include <vector>
+
+//Shadow copy of one program's uniform values.
+//
+//GL keeps uniform values per program, so a value that was already uploaded
+//doesn't need uploading again. Every Set*() compares against the last value
+//sent for that location and only calls glUniform* when it changed.
+//Like glUniform*, the program has to be bound when a Set*() is made.
+//Uniforms start out unknown, so the first Set*() of each one always uploads.
+//Only works if every upload to the program goes through it, so the program's
+//shared one comes from GetUniformState(). Render thread only, the counters
+//aren't synchronized: CommandRecorder's workers record, Execute() sets.
+class UniformState
+{
+public:
+    explicit UniformState(const ProgramReflection& reflection);
+
+    void Set1i(const UniformHandle& uniform, int value);
+    void Set1iv(const UniformHandle& uniform, int count, const int* values);
+    void Set1f(const UniformHandle& uniform, float value);
+    void Set2f(const UniformHandle& uniform, float x, float y);
+    void Set3f(const UniformHandle& uniform, float x, float y, float z);
+    void Set4f(const UniformHandle& uniform, float x, float y, float z, float w);
+    //count array elements, a column-major 4x4 each
+    void SetMatrix4fv(const UniformHandle& uniform, int count, const float* values);
+
+    //forget the shadow, for when something outside UniformState changed the program's uniforms
+    void Invalidate();
+
+    //uploads issued vs skipped, shared by every UniformState on the render thread
+    struct Counters
+    {
+        uint64_t Issued = 0;
+        uint64_t Skipped = 0;
+    };
+    static Counters GetFrameCounters() { return s_Frame; }
+    //call once a frame, moves this frame's counts into the run totals
+    static void EndFrame();
+    //per frame averages and the share of uploads that were skipped, nothing if no Set*() was made
+    static void PrintStats();
+private:
+    struct Slot
+    {
+        unsigned int Offset;     //first byte in m_Values
+        unsigned int Size;       //bytes for the whole array
+        bool Known = false;      //false until the first upload
+    };
+
+    //true when the bytes differ from the shadow (and updates it), counts either way
+    bool Changed(const UniformHandle& uniform, const void* data, unsigned int size);
+
+    std::vector<int> m_SlotByLocation; //-1 for locations that aren't active
+    std::vector<Slot> m_Slots;
+    std::vector<unsigned char> m_Values;
+
+    static Counters s_Frame;
+    static Counters s_Total;
+    static unsigned int s_Frames;
+};
+
+//The shadow for a program CreateShader()/ShaderCompiler reflected, made on first use.
+//nullptr if the program was never reflected
+UniformState* GetUniformState(unsigned int program);
+//ForgetProgramReflection() calls it, GL reuses program names
+void ForgetUniformState(unsigned int program);
@@ -0,0 +1,121 @@
+#include "VertexArray.h"
+#include "GLStateCache.h"
+#include "IndexBuffer.h"
+#include "Renderer.h"
+#include "VertexBuffer.h"
+#include "VertexLayout.h"
+
+#include <utility>
+
+VertexArray::VertexArray()
+{
+    GLCall(glGenVertexArrays(1, &m_RendererID));
+}
+
+VertexArray::~VertexArray()
+{
+    Reset();
+}
+
+VertexArray::VertexArray(VertexArray&& other) noexcept
+    : m_RendererID(std::exchange(other.m_RendererID, 0))
+{
+}
+
+VertexArray& VertexArray::operator=(VertexArray&& other) noexcept
+{
+    if (this != &other)
+        std::swap(m_RendererID, other.m_RendererID);
+    return *this;
+}
+
+void VertexArray::AddAttribute(const VertexBuffer& buffer, unsigned int index, int count, GLenum type,
+    bool normalized, int stride, size_t offset)
+{
+    //the buffer bound to GL_ARRAY_BUFFER when glVertexAttribPointer runs is
+    //the one the VAO records for this attribute
+    Bind();
+    buffer.Bind();
+    GLCall(glEnableVertexAttribArray(index));
+    GLCall(glVertexAttribPointer(index, count, type, normalized ? GL_TRUE : GL_FALSE, stride, (const void*)offset));
+}
+
+void VertexArray::AddBuffer(const VertexBuffer& buffer, const VertexLayoutDesc& layout,
+    unsigned int firstLocation, unsigned int binding, unsigned int divisor)
+{
+    if (binding == BindingFromLocation)
+        binding = firstLocation;
+    if (GLEW_VERSION_4_5 || GLEW_ARB_direct_state_access)
+    {
+        //the fallback path gives every AddBuffer() its own buffer, so must this one
+        int bound = 0;
+        GLCall(glGetVertexArrayIndexediv(m_RendererID, binding, GL_VERTEX_BINDING_BUFFER, &bound));
+        ASSERT(bound == 0 || bound == (int)buffer.GetRendererID());
+        GLCall(glVertexArrayVertexBuffer(m_RendererID, binding, buffer.GetRendererID(), 0, layout.Stride));
+        GLCall(glVertexArrayBindingDivisor(m_RendererID, binding, divisor));
+        for (unsigned int i = 0; i < layout.AttributeCount; i++)
+        {
+            const VertexAttribDesc& attribute = layout.Attributes[i];
+            unsigned int location = firstLocation + i;
+            GLCall(glEnableVertexArrayAttrib(m_RendererID, location));
+            if (attribute.FetchAs == VertexFetch::Integer)
+            {
+                GLCall(glVertexArrayAttribIFormat(m_RendererID, location, attribute.Count, attribute.Type, attribute.Offset));
+            }
+            else
+            {
+                GLCall(glVertexArrayAttribFormat(m_RendererID, location, attribute.Count, attribute.Type,
+                    attribute.FetchAs == VertexFetch::Normalized ? GL_TRUE : GL_FALSE, attribute.Offset));
+            }
+            GLCall(glVertexArrayAttribBinding(m_RendererID, location, binding));
+        }
+        return;
+    }
+
+    Bind();
+    buffer.Bind();
+    for (unsigned int i = 0; i < layout.AttributeCount; i++)
+    {
+        const VertexAttribDesc& attribute = layout.Attributes[i];
+        unsigned int location = firstLocation + i;
+        GLCall(glEnableVertexAttribArray(location));
+        if (attribute.FetchAs == VertexFetch::Integer)
+        {
+            GLCall(glVertexAttribIPointer(location, attribute.Count, attribute.Type, layout.Stride,
+                (const void*)(size_t)attribute.Offset));
+        }
+        else
+        {
+            GLCall(glVertexAttribPointer(location, attribute.Count, attribute.Type,
+                attribute.FetchAs == VertexFetch::Normalized ? GL_TRUE : GL_FALSE, layout.Stride,
+                (const void*)(size_t)attribute.Offset));
+        }
+        GLCall(glVertexAttribDivisor(location, divisor));
+    }
+}
+
+void VertexArray::SetIndexBuffer(const IndexBuffer& buffer)
+{
+    Bind();
+    buffer.Bind();
+}
+
+void VertexArray::Bind() const
+{
+    GLStateCache::Get().BindVertexArray(m_RendererID);
+}
+
+void VertexArray::Unbind() const
+{
+    GLStateCache::Get().BindVertexArray(0);
+}
+
+void VertexArray::Reset()
+{
+    if (m_RendererID)
+    {
+        GLStateCache::Get().ForgetVertexArray(m_RendererID);
+        GLCall(glDeleteVertexArrays(1, &m_RendererID));
+    }
+    m_RendererID = 0;
+}
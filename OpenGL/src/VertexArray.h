@@ -0,0 +1,54 @@
+#pragma once
+#include <GL/glew.h>
+#include <cstddef>
+
+class IndexBuffer;
+class VertexBuffer;
+struct VertexLayoutDesc;
+
+//Owns one vertex array object. Move-only, same rules as VertexBuffer.
+//
+//The VAO remembers every attribute's buffer, format and the index buffer,
+//so after setting them up once a draw only needs Bind(). It doesn't own the
+//buffers it points at, those have to outlive it (or at least its draws).
+class VertexArray
+{
+public:
+    //generates the name, needs a current context
+    VertexArray();
+    ~VertexArray();
+
+    VertexArray(const VertexArray&) = delete;
+    VertexArray& operator=(const VertexArray&) = delete;
+    VertexArray(VertexArray&& other) noexcept;
+    VertexArray& operator=(VertexArray&& other) noexcept;
+
+    //one attribute read from buffer, the arguments are glVertexAttribPointer's.
+    //Leaves this VAO bound
+    void AddAttribute(const VertexBuffer& buffer, unsigned int index, int count, GLenum type,
+        bool normalized, int stride, size_t offset);
+    //binding for AddBuffer() that picks firstLocation, so buffers added at
+    //different locations never share a binding point
+    static const unsigned int BindingFromLocation = ~0u;
+
+    //every attribute of a VertexLayout<...>, attribute i at location firstLocation + i.
+    //With GL 4.5/ARB_direct_state_access the format goes in through
+    //glVertexArrayAttribFormat on buffer binding point binding, without binding
+    //anything, otherwise through glVertexAttribPointer and this VAO is left bound.
+    //Only the DSA path has binding points: two buffers given the same one would
+    //both be read from the last, so it's checked with an ASSERT.
+    //A divisor of 1 advances the attributes once per instance instead of per vertex
+    void AddBuffer(const VertexBuffer& buffer, const VertexLayoutDesc& layout,
+        unsigned int firstLocation = 0, unsigned int binding = BindingFromLocation, unsigned int divisor = 0);
+    //leaves this VAO bound
+    void SetIndexBuffer(const IndexBuffer& buffer);
+
+    void Bind() const;
+    void Unbind() const;
+    //see VertexBuffer::Reset()
+    void Reset();
+
+    unsigned int GetRendererID() const { return m_RendererID; }
+private:
+    unsigned int m_RendererID = 0;
+};
@@ -0,0 +1,80 @@
+#include "VertexBuffer.h"
+#include "GLStateCache.h"
+#include "Renderer.h"
+
+#include <utility>
+
+VertexBuffer::VertexBuffer(const void* data, unsigned int size, GLenum usage)
+    : m_Size(size), m_Usage(usage)
+{
+    GLCall(glGenBuffers(1, &m_RendererID));
+    GLStateCache::Get().BindBuffer(GL_ARRAY_BUFFER, m_RendererID);
+    GLCall(glBufferData(GL_ARRAY_BUFFER, size, data, usage));
+}
+
+VertexBuffer::~VertexBuffer()
+{
+    Reset();
+}
+
+VertexBuffer::VertexBuffer(VertexBuffer&& other) noexcept
+    : m_RendererID(std::exchange(other.m_RendererID, 0)), m_Size(std::exchange(other.m_Size, 0)), m_Usage(other.m_Usage)
+{
+}
+
+VertexBuffer& VertexBuffer::operator=(VertexBuffer&& other) noexcept
+{
+    if (this != &other)
+    {
+        //swapping hands our old name to other, whose destructor deletes it
+        std::swap(m_RendererID, other.m_RendererID);
+        std::swap(m_Size, other.m_Size);
+        std::swap(m_Usage, other.m_Usage);
+    }
+    return *this;
+}
+
+void VertexBuffer::Bind() const
+{
+    GLStateCache::Get().BindBuffer(GL_ARRAY_BUFFER, m_RendererID);
+}
+
+void VertexBuffer::Unbind() const
+{
+    GLStateCache::Get().BindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void VertexBuffer::Upload(const void* data, unsigned int size, unsigned int offset)
+{
+    if (!m_RendererID)
+    {
+        GLCall(glGenBuffers(1, &m_RendererID));
+    }
+    GLStateCache::Get().BindBuffer(GL_ARRAY_BUFFER, m_RendererID);
+    if (offset + size > m_Size)
+    {
+        //a new store is uninitialized, the bytes before offset only survive if offset is 0
+        ASSERT(offset == 0);
+        m_Size = size;
+        GLCall(glBufferData(GL_ARRAY_BUFFER, size, data, m_Usage));
+        return;
+    }
+    GLCall(glBufferSubData(GL_ARRAY_BUFFER, offset, size, data));
+}
+
+void VertexBuffer::Orphan()
+{
+    GLStateCache::Get().BindBuffer(GL_ARRAY_BUFFER, m_RendererID);
+    GLCall(glBufferData(GL_ARRAY_BUFFER, m_Size, nullptr, m_Usage));
+}
+
+void VertexBuffer::Reset()
+{
+    if (m_RendererID)
+    {
+        GLStateCache::Get().ForgetBuffer(m_RendererID);
+        GLCall(glDeleteBuffers(1, &m_RendererID));
+    }
+    m_RendererID = 0;
+    m_Size = 0;
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include <GL/glew.h>
+
+//Owns one GL buffer holding vertex data.
+//
+//Move-only: a move hands the name over and leaves the source empty, so
+//buffers can live in std::vector and the like, and whoever ends up owning
+//the name deletes it in the destructor. That destructor needs the context
+//still current, anything that would outlive it has to be Reset() first.
+class VertexBuffer
+{
+public:
+    VertexBuffer() = default;
+    //size in bytes, data may be nullptr to only allocate
+    VertexBuffer(const void* data, unsigned int size, GLenum usage = GL_STATIC_DRAW);
+    ~VertexBuffer();
+
+    VertexBuffer(const VertexBuffer&) = delete;
+    VertexBuffer& operator=(const VertexBuffer&) = delete;
+    VertexBuffer(VertexBuffer&& other) noexcept;
+    VertexBuffer& operator=(VertexBuffer&& other) noexcept;
+
+    void Bind() const;
+    void Unbind() const;
+    //deletes the name now instead of in the destructor, for things that live
+    //until after the context is gone. Leaves the object empty
+    void Reset();
+
+    //overwrites size bytes at offset. Replacing everything (offset 0) with more
+    //than fits reallocates the buffer with its usage, running past the end at any
+    //other offset ASSERTs. Leaves the buffer bound to GL_ARRAY_BUFFER
+    void Upload(const void* data, unsigned int size, unsigned int offset = 0);
+
+    //replaces the store with a new uninitialized one of the same size, so an
+    //Upload() after it never waits on draws still reading the old contents.
+    //Leaves the buffer bound to GL_ARRAY_BUFFER
+    void Orphan();
+
+    unsigned int GetRendererID() const { return m_RendererID; }
+    unsigned int GetSize() const { return m_Size; }
+private:
+    unsigned int m_RendererID = 0;
+    unsigned int m_Size = 0;
+    GLenum m_Usage = GL_STATIC_DRAW;
+};
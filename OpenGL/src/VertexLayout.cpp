@@ -0,0 +1,54 @@
+#include "VertexLayout.h"
+#include "ShaderReflection.h"
+
+#include <iostream>
+
+static bool IsIntegerInput(GLenum type)
+{
+    switch (type)
+    {
+    case GL_INT: case GL_INT_VEC2: case GL_INT_VEC3: case GL_INT_VEC4:
+    case GL_UNSIGNED_INT: case GL_UNSIGNED_INT_VEC2: case GL_UNSIGNED_INT_VEC3: case GL_UNSIGNED_INT_VEC4:
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool ValidateVertexLayout(std::initializer_list<VertexStream> streams, unsigned int program, const char* name)
+{
+    const ProgramReflection* reflection = GetProgramReflection(program);
+    if (!reflection)
+    {
+        std::cout << "[VertexLayout] " << name << " was never reflected, can't check its layout" << std::endl;
+        return false;
+    }
+
+    bool valid = true;
+    for (const AttributeHandle& input : reflection->GetAttributes())
+    {
+        const VertexAttribDesc* attribute = nullptr;
+        for (const VertexStream& stream : streams)
+        {
+            int index = input.Location - (int)stream.FirstLocation;
+            if (index >= 0 && index < (int)stream.Layout.AttributeCount)
+                attribute = &stream.Layout.Attributes[index];
+        }
+        if (!attribute)
+        {
+            std::cout << "[VertexLayout] " << name << " reads location " << input.Location
+                << " but no layout has an attribute there" << std::endl;
+            valid = false;
+            continue;
+        }
+        bool integerInput = IsIntegerInput(input.Type);
+        if (integerInput != (attribute->FetchAs == VertexFetch::Integer))
+        {
+            std::cout << "[VertexLayout] " << name << " location " << input.Location << " is "
+                << (integerInput ? "an int" : "a float") << " input but the layout reads it as "
+                << (integerInput ? "float" : "integer") << std::endl;
+            valid = false;
+        }
+    }
+    return valid;
+}
@@ -0,0 +1,112 @@
+#pragma once
+#include <GL/glew.h>
+#include <array>
+#include <cstdint>
+#include <initializer_list>
+
+//GL type enum for a C++ component type
+template<typename T> struct VertexComponentType;
+template<> struct VertexComponentType<float> { static constexpr GLenum Value = GL_FLOAT; };
+template<> struct VertexComponentType<int8_t> { static constexpr GLenum Value = GL_BYTE; };
+template<> struct VertexComponentType<uint8_t> { static constexpr GLenum Value = GL_UNSIGNED_BYTE; };
+template<> struct VertexComponentType<int16_t> { static constexpr GLenum Value = GL_SHORT; };
+template<> struct VertexComponentType<uint16_t> { static constexpr GLenum Value = GL_UNSIGNED_SHORT; };
+template<> struct VertexComponentType<int32_t> { static constexpr GLenum Value = GL_INT; };
+template<> struct VertexComponentType<uint32_t> { static constexpr GLenum Value = GL_UNSIGNED_INT; };
+
+//How one attribute is read from the buffer.
+//Normalized maps integers to [0, 1] / [-1, 1] for a float input, Integer keeps
+//them integers for an int/uint input (glVertexAttribIPointer). Neither set on
+//an integer type converts it to float as is.
+enum class VertexFetch
+{
+    Float, Normalized, Integer
+};
+
+template<typename T, int ComponentCount, VertexFetch Fetch = VertexFetch::Float>
+struct VertexAttrib
+{
+    static_assert(ComponentCount >= 1 && ComponentCount <= 4, "a vertex attribute has 1 to 4 components");
+    static_assert(Fetch == VertexFetch::Float || VertexComponentType<T>::Value != GL_FLOAT,
+        "only integer components can be normalized or read as integers");
+
+    using Component = T;
+    static constexpr int Count = ComponentCount;
+    static constexpr GLenum Type = VertexComponentType<T>::Value;
+    static constexpr VertexFetch FetchAs = Fetch;
+    static constexpr unsigned int Size = sizeof(T) * ComponentCount;
+};
+
+//the common ones
+using Float1 = VertexAttrib<float, 1>;
+using Float2 = VertexAttrib<float, 2>;
+using Float3 = VertexAttrib<float, 3>;
+using Float4 = VertexAttrib<float, 4>;
+using UByte4Norm = VertexAttrib<uint8_t, 4, VertexFetch::Normalized>; //packed RGBA color
+using Int1 = VertexAttrib<int32_t, 1, VertexFetch::Integer>;
+
+//One attribute of a layout as plain data, what the GL setup code reads
+struct VertexAttribDesc
+{
+    GLenum Type;
+    int Count;
+    VertexFetch FetchAs;
+    unsigned int Offset;
+};
+
+//A whole layout without the template, so the GL calls can live in one .cpp
+struct VertexLayoutDesc
+{
+    const VertexAttribDesc* Attributes;
+    unsigned int AttributeCount;
+    unsigned int Stride;
+};
+
+//Stride, offsets, types and normalization of an interleaved vertex, all
+//worked out by the compiler. Attribute i goes to location firstLocation + i:
+//  struct QuadVertex { float Position[2]; uint8_t Color[4]; };
+//  using QuadLayout = VertexLayout<Float2, UByte4Norm>;
+//  static_assert(QuadLayout::Stride == sizeof(QuadVertex));
+//  va.AddBuffer(vb, QuadLayout());
+//Attributes are tightly packed in the order given, like members of a struct
+//with no padding, so put the bigger ones first if the struct would pad.
+template<typename... Attribs>
+struct VertexLayout
+{
+    static constexpr unsigned int AttributeCount = sizeof...(Attribs);
+    static constexpr unsigned int Stride = (0u + ... + Attribs::Size);
+
+    static constexpr std::array<VertexAttribDesc, AttributeCount> Compute()
+    {
+        std::array<VertexAttribDesc, AttributeCount> result{};
+        unsigned int offset = 0;
+        unsigned int i = 0;
+        ((result[i++] = { Attribs::Type, Attribs::Count, Attribs::FetchAs, offset }, offset += Attribs::Size), ...);
+        return result;
+    }
+    static constexpr std::array<VertexAttribDesc, AttributeCount> Attributes = Compute();
+
+    static constexpr unsigned int Offset(unsigned int index) { return Attributes[index].Offset; }
+
+    constexpr operator VertexLayoutDesc() const { return { Attributes.data(), AttributeCount, Stride }; }
+};
+
+//One layout and the location its first attribute goes to, a VAO fed from
+//several buffers (per vertex and per instance, say) has one of these per buffer
+struct VertexStream
+{
+    VertexLayoutDesc Layout;
+    unsigned int FirstLocation;
+};
+
+//Compares layouts against the vertex inputs ReflectProgram() found.
+//Every active input needs an attribute at its location, and an int/uint input
+//needs one read as VertexFetch::Integer (and the other way around), otherwise
+//the draw reads constant or garbage values without any GL error.
+//Prints each problem with the program's name and returns false if there was one.
+bool ValidateVertexLayout(std::initializer_list<VertexStream> streams, unsigned int program, const char* name);
+inline bool ValidateVertexLayout(const VertexLayoutDesc& layout, unsigned int firstLocation,
+    unsigned int program, const char* name)
+{
+    return ValidateVertexLayout({ { layout, firstLocation } }, program, name);
+}
@@ -4,8 +4,20 @@
 #include <fstream>
 #include <string>
 #include <sstream>
+#include <cstring>
+#include <cstdlib>
+//shared with the OpenGL project instead of a copy that would drift
+#include "../../OpenGL/src/Headless.h"
 //__debugbreak() is MSVC compiler specific
-#define ASSERT(x) if (!(x)) __debugbreak(); 
+#ifdef _MSC_VER
+#include <malloc.h>
+#define DEBUG_BREAK() __debugbreak()
+#else
+#include <alloca.h>
+#include <csignal>
+#define DEBUG_BREAK() raise(SIGTRAP)
+#endif
+#define ASSERT(x) if (!(x)) DEBUG_BREAK(); 
 #define GLCall(x) GLClearError();\
     x;\
     ASSERT(GLLogCall(#x, __FILE__, __LINE__))
@@ -104,29 +116,71 @@ static ShaderProgramSource ParseShader(const std::string& filepath)
 }
 
 
-int main()
+struct AppOptions
 {
-    GLFWwindow* window;
-    /* Initialize the library */
-    if (!glfwInit())
-        return -1;
-
-    /* Create a windowed mode window and its OpenGL context */
-    window = glfwCreateWindow(640, 480, "Hello World", NULL, NULL);
-    if (!window)
+    bool Headless = false;
+    int Frames = 600;
+};
+
+static AppOptions ParseOptions(int argc, char** argv)
+{
+    AppOptions options;
+    for (int i = 1; i < argc; i++)
     {
-        glfwTerminate();
-        return -1;
+        if (strcmp(argv[i], "--headless") == 0)
+            options.Headless = true;
+        else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc)
+            options.Frames = atoi(argv[++i]);
+        else
+            std::cout << "Unknown option: " << argv[i] << std::endl;
     }
+    return options;
+}
 
-    /* Make the window's context current */
-    glfwMakeContextCurrent(window);
-    glfwSwapInterval(1);
+int main(int argc, char** argv)
+{
+    AppOptions options = ParseOptions(argc, argv);
+    GLFWwindow* window = nullptr;
+    HeadlessContext headless;
 
-    if (glewInit() != GLEW_OK)
+    if (options.Headless)
+    {
+        if (!headless.Create())
+            return -1;
+        glewExperimental = GL_TRUE;
+    }
+    else
+    {
+        /* Initialize the library */
+        if (!glfwInit())
+            return -1;
+
+        /* Create a windowed mode window and its OpenGL context */
+        window = glfwCreateWindow(640, 480, "Hello World", NULL, NULL);
+        if (!window)
+        {
+            glfwTerminate();
+            return -1;
+        }
+
+        /* Make the window's context current */
+        glfwMakeContextCurrent(window);
+        glfwSwapInterval(1);
+    }
+
+    GLenum glewStatus = glewInit();
+    if (glewStatus != GLEW_OK && !(options.Headless && glewStatus == GLEW_ERROR_NO_GLX_DISPLAY))
         std::cout << "ERROR" << std::endl;
 
     std::cout << glGetString(GL_VERSION) << std::endl;
+
+    OffscreenTarget offscreen;
+    if (options.Headless)
+    {
+        if (!offscreen.Create(640, 480))
+            return -1;
+        offscreen.Bind();
+    }
     unsigned int buffer;
     unsigned int vao;
     GLCall(glGenVertexArrays(1, &vao));
@@ -164,7 +218,10 @@ int main()
 
     float r = 0.0f;
     float increment = 0.05f;
-    while (!glfwWindowShouldClose(window))
+    FrameTimer timer;
+    timer.BeginRun();
+    int frame = 0;
+    while (options.Headless ? frame < options.Frames : !glfwWindowShouldClose(window))
     {
         /* Render here */
         glClear(GL_COLOR_BUFFER_BIT);
@@ -179,13 +236,34 @@ int main()
 
         r += increment;
 
+        frame++;
+        if (options.Headless)
+        {
+            timer.EndFrame();
+            continue;
+        }
+
         /* Swap front and back buffers */
         glfwSwapBuffers(window);
         /* Poll for and process events */
         glfwPollEvents();
     }
+
+    if (options.Headless)
+    {
+        glFinish();
+        timer.EndRun();
+        timer.Print();
+    }
+
     //glDeleteShader(shader);
     glDeleteProgram(shader);
-    glfwTerminate();
+    if (options.Headless)
+    {
+        offscreen.Destroy();
+        headless.Destroy();
+    }
+    else
+        glfwTerminate();
     return 0;
 }
\ No newline at end of file
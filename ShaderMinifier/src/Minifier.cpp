@@ -0,0 +1,549 @@
+#include "Minifier.h"
+
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <set>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+enum class TokenType
+{
+    Identifier, Number, Operator, Directive
+};
+
+struct Token
+{
+    TokenType Type;
+    std::string Text;
+};
+
+static bool IsIdentifierStart(char c)
+{
+    return isalpha((unsigned char)c) || c == '_';
+}
+
+static bool IsIdentifierChar(char c)
+{
+    return isalnum((unsigned char)c) || c == '_';
+}
+
+//longest first, so "<<=" wins over "<<" and "<"
+static const char* s_Operators[] = {
+    "<<=", ">>=", "++", "--", "<<", ">>", "<=", ">=", "==", "!=", "&&", "||", "^^",
+    "+=", "-=", "*=", "/=", "%=", "&=", "|=", "^="
+};
+
+//a directive with its comments removed and whitespace runs collapsed
+static std::string CleanDirective(std::string_view line)
+{
+    std::string result;
+    bool pendingSpace = false;
+    for (size_t i = 0; i < line.size(); i++)
+    {
+        char c = line[i];
+        if (c == '/' && i + 1 < line.size() && line[i + 1] == '/')
+            break;
+        if (c == '/' && i + 1 < line.size() && line[i + 1] == '*')
+        {
+            size_t end = line.find("*/", i + 2);
+            i = end == std::string_view::npos ? line.size() : end + 1;
+            pendingSpace = true;
+            continue;
+        }
+        if (c == '\\' && i + 1 < line.size() && (line[i + 1] == '\n' || line[i + 1] == '\r'))
+        {
+            pendingSpace = true;
+            continue;
+        }
+        if (isspace((unsigned char)c))
+        {
+            pendingSpace = true;
+            continue;
+        }
+        if (pendingSpace && !result.empty())
+            result += ' ';
+        pendingSpace = false;
+        result += c;
+    }
+    return result;
+}
+
+static std::vector<Token> Tokenize(std::string_view source)
+{
+    std::vector<Token> tokens;
+    bool lineStart = true;
+    for (size_t i = 0; i < source.size();)
+    {
+        char c = source[i];
+        if (c == '\n')
+        {
+            lineStart = true;
+            i++;
+            continue;
+        }
+        if (isspace((unsigned char)c))
+        {
+            i++;
+            continue;
+        }
+        if (c == '/' && i + 1 < source.size() && source[i + 1] == '/')
+        {
+            while (i < source.size() && source[i] != '\n')
+                i++;
+            continue;
+        }
+        if (c == '/' && i + 1 < source.size() && source[i + 1] == '*')
+        {
+            size_t end = source.find("*/", i + 2);
+            i = end == std::string_view::npos ? source.size() : end + 2;
+            continue;
+        }
+
+        if (c == '#' && lineStart)
+        {
+            //to the end of the line, following backslash continuations
+            size_t end = i;
+            while (end < source.size() && source[end] != '\n')
+            {
+                if (source[end] == '\\' && end + 1 < source.size() && source[end + 1] == '\n')
+                    end++;
+                end++;
+            }
+            tokens.push_back({ TokenType::Directive, CleanDirective(source.substr(i, end - i)) });
+            i = end;
+            continue;
+        }
+        lineStart = false;
+
+        size_t start = i;
+        if (IsIdentifierStart(c))
+        {
+            while (i < source.size() && IsIdentifierChar(source[i]))
+                i++;
+            tokens.push_back({ TokenType::Identifier, std::string(source.substr(start, i - start)) });
+        }
+        else if (isdigit((unsigned char)c) || (c == '.' && i + 1 < source.size() && isdigit((unsigned char)source[i + 1])))
+        {
+            while (i < source.size())
+            {
+                char n = source[i];
+                bool exponentSign = (n == '+' || n == '-') && (source[i - 1] == 'e' || source[i - 1] == 'E')
+                    && !(source[start] == '0' && start + 1 < source.size() && (source[start + 1] == 'x' || source[start + 1] == 'X'));
+                if (!(IsIdentifierChar(n) || n == '.' || exponentSign))
+                    break;
+                i++;
+            }
+            tokens.push_back({ TokenType::Number, std::string(source.substr(start, i - start)) });
+        }
+        else
+        {
+            std::string op(1, c);
+            for (const char* candidate : s_Operators)
+            {
+                size_t length = strlen(candidate);
+                if (source.compare(i, length, candidate) == 0)
+                {
+                    op = candidate;
+                    break;
+                }
+            }
+            i += op.size();
+            tokens.push_back({ TokenType::Operator, op });
+        }
+    }
+    return tokens;
+}
+
+//-------------------------------------------------------------------------
+//literals and folding
+
+struct Literal
+{
+    bool IsFloat;
+    double Value;
+};
+
+//only plain decimal literals: no hex, octal or suffixes (u, f, lf), which
+//would need their own rules
+static bool ParseLiteral(const std::string& text, Literal& literal)
+{
+    bool isFloat = false;
+    for (char c : text)
+    {
+        if (c == '.' || c == 'e' || c == 'E')
+            isFloat = true;
+        else if (!isdigit((unsigned char)c) && c != '+' && c != '-')
+            return false;
+    }
+    if (!isFloat && text.size() > 1 && text[0] == '0')
+        return false;
+    literal.IsFloat = isFloat;
+    literal.Value = isFloat ? (double)strtof(text.c_str(), nullptr) : strtod(text.c_str(), nullptr);
+    return true;
+}
+
+//shortest text that the driver reads back as the same 32-bit float
+static std::string FormatFloat(float value)
+{
+    char buffer[64];
+    for (int precision = 1; precision <= 9; precision++)
+    {
+        snprintf(buffer, sizeof(buffer), "%.*g", precision, value);
+        if (strtof(buffer, nullptr) == value)
+            break;
+    }
+    std::string text = buffer;
+    if (text.find_first_of(".e") == std::string::npos)
+        text += ".";
+    //"0.5" -> ".5" (but "0." stays), "1e+10" -> "1e10"
+    if (text.size() > 2 && text.compare(0, 2, "0.") == 0 && isdigit((unsigned char)text[2]))
+        text.erase(0, 1);
+    size_t plus = text.find("e+");
+    if (plus != std::string::npos)
+        text.erase(plus + 1, 1);
+    return text;
+}
+
+static int Precedence(const std::string& op)
+{
+    if (op == "*" || op == "/" || op == "%")
+        return 2;
+    if (op == "+" || op == "-")
+        return 1;
+    return 0;
+}
+
+//tokens a folded "a op b" may follow without binding differently
+static bool StartsOperand(const Token& token)
+{
+    if (token.Type == TokenType::Identifier)
+        return token.Text == "return";
+    if (token.Type != TokenType::Operator)
+        return false;
+    static const std::set<std::string> starts = { "(", ",", "=", "?", ":", "[", ";", "{", "}",
+        "+=", "-=", "*=", "/=", "&&", "||", "^^", "==", "!=", "<", ">", "<=", ">=" };
+    return starts.count(token.Text) != 0;
+}
+
+static unsigned int FoldConstants(std::vector<Token>& tokens)
+{
+    unsigned int folded = 0;
+    bool changed = true;
+    while (changed)
+    {
+        changed = false;
+        for (size_t i = 0; i + 2 < tokens.size(); i++)
+        {
+            const Token& left = tokens[i];
+            const Token& op = tokens[i + 1];
+            const Token& right = tokens[i + 2];
+            int precedence = Precedence(op.Text);
+            if (left.Type != TokenType::Number || op.Type != TokenType::Operator || right.Type != TokenType::Number
+                || precedence == 0 || op.Text == "%")
+                continue;
+
+            //"x * 2 + 3" mustn't become "x * 5": what's before may only start an operand,
+            //or for * and / be a lower precedence operator. What's after mustn't bind tighter.
+            bool beforeOk = i == 0 || StartsOperand(tokens[i - 1])
+                || (precedence == 2 && tokens[i - 1].Type == TokenType::Operator && Precedence(tokens[i - 1].Text) == 1
+                    && (i < 2 || tokens[i - 2].Type != TokenType::Operator || tokens[i - 2].Text == ")"));
+            bool afterOk = i + 3 >= tokens.size() || tokens[i + 3].Type != TokenType::Operator
+                || (Precedence(tokens[i + 3].Text) <= precedence && tokens[i + 3].Text != "." && tokens[i + 3].Text != "[");
+            if (i > 0 && (tokens[i - 1].Text == "-" || tokens[i - 1].Text == "+") && precedence == 1)
+                beforeOk = false; //a - 1 + 2 is (a - 1) + 2
+            if (!beforeOk || !afterOk)
+                continue;
+
+            Literal a, b;
+            if (!ParseLiteral(left.Text, a) || !ParseLiteral(right.Text, b) || a.IsFloat != b.IsFloat)
+                continue;
+
+            std::string result;
+            if (a.IsFloat)
+            {
+                float x = (float)a.Value, y = (float)b.Value, r;
+                if (op.Text == "+") r = x + y;
+                else if (op.Text == "-") r = x - y;
+                else if (op.Text == "*") r = x * y;
+                else
+                {
+                    if (y == 0.0f)
+                        continue;
+                    r = x / y;
+                }
+                if (!std::isfinite(r) || r < 0.0f)
+                    continue;
+                result = FormatFloat(r);
+            }
+            else
+            {
+                long long x = (long long)a.Value, y = (long long)b.Value, r;
+                if (op.Text == "+") r = x + y;
+                else if (op.Text == "-") r = x - y;
+                else if (op.Text == "*") r = x * y;
+                else
+                {
+                    if (y == 0)
+                        continue;
+                    r = x / y;
+                }
+                //a negative result would need a unary minus in front, leave those alone
+                if (r < 0 || r > 2147483647ll)
+                    continue;
+                result = std::to_string(r);
+            }
+
+            tokens[i].Text = result;
+            tokens.erase(tokens.begin() + i + 1, tokens.begin() + i + 3);
+            folded++;
+            changed = true;
+        }
+
+        //a folded literal left alone in parentheses loses them: (0.5) -> 0.5, unless it's a call
+        for (size_t i = 1; i + 1 < tokens.size(); i++)
+        {
+            bool call = i >= 2 && (tokens[i - 2].Type != TokenType::Operator || tokens[i - 2].Text == ")" || tokens[i - 2].Text == "]");
+            if (tokens[i].Type == TokenType::Number && tokens[i - 1].Text == "(" && tokens[i + 1].Text == ")" && !call)
+            {
+                tokens.erase(tokens.begin() + i + 1);
+                tokens.erase(tokens.begin() + i - 1);
+                changed = true;
+            }
+        }
+    }
+
+    for (Token& token : tokens)
+    {
+        Literal literal;
+        if (token.Type == TokenType::Number && ParseLiteral(token.Text, literal) && literal.IsFloat)
+            token.Text = FormatFloat((float)literal.Value);
+    }
+    return folded;
+}
+
+//-------------------------------------------------------------------------
+//renaming
+
+static const std::unordered_set<std::string> s_TypeNames = {
+    "float", "int", "uint", "bool", "double",
+    "vec2", "vec3", "vec4", "ivec2", "ivec3", "ivec4", "uvec2", "uvec3", "uvec4",
+    "bvec2", "bvec3", "bvec4", "dvec2", "dvec3", "dvec4",
+    "mat2", "mat3", "mat4", "mat2x2", "mat2x3", "mat2x4", "mat3x2", "mat3x3", "mat3x4", "mat4x2", "mat4x3", "mat4x4",
+};
+
+static const std::unordered_set<std::string> s_Qualifiers = {
+    "const", "in", "out", "inout", "highp", "mediump", "lowp", "precise"
+};
+
+//the short names that mean something already
+static const std::unordered_set<std::string> s_Reserved = {
+    "do", "if", "in", "for", "int", "out", "asm", "goto", "long", "true", "void", "case", "enum", "else", "uint",
+    "bool", "vec2", "vec3", "vec4", "mat2", "mat3", "mat4", "flat", "half", "main", "char", "cast", "lowp", "class",
+};
+
+static std::string ShortName(unsigned int index)
+{
+    std::string name;
+    do
+    {
+        name += (char)('a' + index % 26);
+        index /= 26;
+    } while (index-- > 0);
+    return name;
+}
+
+struct FunctionRange
+{
+    size_t ParamsBegin; //the "(" of the parameter list
+    size_t BodyEnd;     //the "}" closing the body
+};
+
+static std::vector<FunctionRange> FindFunctions(const std::vector<Token>& tokens)
+{
+    std::vector<FunctionRange> functions;
+    int depth = 0;
+    for (size_t i = 0; i < tokens.size(); i++)
+    {
+        const std::string& text = tokens[i].Text;
+        if (tokens[i].Type != TokenType::Operator)
+            continue;
+        //at file scope, "name ( ... ) {" is a function definition
+        if (text == "{" && depth == 0 && i > 0 && tokens[i - 1].Text == ")")
+        {
+            int parens = 0;
+            size_t open = i - 1;
+            for (; open > 0; open--)
+            {
+                if (tokens[open].Text == ")")
+                    parens++;
+                else if (tokens[open].Text == "(" && --parens == 0)
+                    break;
+            }
+            int braces = 0;
+            size_t close = i;
+            for (; close < tokens.size(); close++)
+            {
+                if (tokens[close].Text == "{")
+                    braces++;
+                else if (tokens[close].Text == "}" && --braces == 0)
+                    break;
+            }
+            if (close == tokens.size())
+                break;
+            functions.push_back({ open, close });
+            i = close;
+            continue;
+        }
+        if (text == "{")
+            depth++;
+        else if (text == "}")
+            depth--;
+    }
+    return functions;
+}
+
+static unsigned int RenameLocals(std::vector<Token>& tokens)
+{
+    std::unordered_set<std::string> structNames;
+    std::unordered_set<std::string> directiveWords;
+    std::unordered_set<std::string> allNames;
+    for (size_t i = 0; i < tokens.size(); i++)
+    {
+        if (tokens[i].Type == TokenType::Identifier)
+            allNames.insert(tokens[i].Text);
+        if (tokens[i].Text == "struct" && i + 1 < tokens.size())
+            structNames.insert(tokens[i + 1].Text);
+        if (tokens[i].Type == TokenType::Directive)
+        {
+            //every word of every directive, macros can mention anything
+            const std::string& text = tokens[i].Text;
+            for (size_t c = 0; c < text.size();)
+            {
+                size_t start = c;
+                while (c < text.size() && IsIdentifierChar(text[c]))
+                    c++;
+                if (c > start)
+                    directiveWords.insert(text.substr(start, c - start));
+                else
+                    c++;
+            }
+        }
+    }
+
+    std::vector<FunctionRange> functions = FindFunctions(tokens);
+    //where each name is used, so a local that is also used outside its function is left alone
+    std::unordered_map<std::string, std::vector<size_t>> uses;
+    for (size_t i = 0; i < tokens.size(); i++)
+    {
+        if (tokens[i].Type == TokenType::Identifier && (i == 0 || tokens[i - 1].Text != "."))
+            uses[tokens[i].Text].push_back(i);
+    }
+
+    unsigned int renamed = 0;
+    for (const FunctionRange& function : functions)
+    {
+        //declarations: [qualifiers] type name, followed by = ; , [ or ) in a parameter list
+        std::vector<std::string> locals;
+        for (size_t i = function.ParamsBegin + 1; i + 1 < function.BodyEnd; i++)
+        {
+            const Token& type = tokens[i];
+            const Token& name = tokens[i + 1];
+            if (type.Type != TokenType::Identifier || name.Type != TokenType::Identifier
+                || !(s_TypeNames.count(type.Text) || structNames.count(type.Text)))
+                continue;
+            const Token& before = tokens[i - 1];
+            bool declarationStart = before.Text == "(" || before.Text == "," || before.Text == ";"
+                || before.Text == "{" || before.Text == "}" || s_Qualifiers.count(before.Text);
+            const std::string& after = tokens[i + 2].Text;
+            bool declarationEnd = after == "=" || after == ";" || after == "," || after == "[" || after == ")";
+            if (declarationStart && declarationEnd && s_TypeNames.count(name.Text) == 0)
+                locals.push_back(name.Text);
+        }
+
+        unsigned int nextName = 0;
+        for (const std::string& local : locals)
+        {
+            if (directiveWords.count(local))
+                continue;
+            const std::vector<size_t>& positions = uses[local];
+            bool onlyInside = true;
+            for (size_t position : positions)
+                onlyInside &= position > function.ParamsBegin && position < function.BodyEnd;
+            if (!onlyInside)
+                continue;
+
+            std::string shortName;
+            do
+                shortName = ShortName(nextName++);
+            while (allNames.count(shortName) || s_Reserved.count(shortName) || directiveWords.count(shortName));
+            if (shortName.size() >= local.size())
+                continue;
+
+            for (size_t position : positions)
+                tokens[position].Text = shortName;
+            allNames.insert(shortName);
+            renamed++;
+        }
+    }
+    return renamed;
+}
+
+//-------------------------------------------------------------------------
+
+static bool NeedsSpace(const Token& previous, const Token& next)
+{
+    bool previousWord = previous.Type == TokenType::Identifier || previous.Type == TokenType::Number;
+    bool nextWord = next.Type == TokenType::Identifier || next.Type == TokenType::Number;
+    if (previousWord && nextWord)
+        return true;
+    //"1." followed by ".x"-like tokens, or a number running into a following ".5"
+    if (previous.Type == TokenType::Number && next.Text[0] == '.')
+        return true;
+    if (previous.Type != TokenType::Operator || next.Type != TokenType::Operator)
+        return false;
+    //"a - -b", "a + +b", "/" "*" starting a comment, ...
+    std::string joined = previous.Text + next.Text;
+    for (const char* op : s_Operators)
+    {
+        if (joined.compare(0, strlen(op), op) == 0 && strlen(op) > previous.Text.size())
+            return true;
+    }
+    return joined.compare(0, 2, "//") == 0 || joined.compare(0, 2, "/*") == 0;
+}
+
+std::string MinifyGLSL(std::string_view source, MinifyStats* stats)
+{
+    std::vector<Token> tokens = Tokenize(source);
+    unsigned int folded = FoldConstants(tokens);
+    unsigned int renamed = RenameLocals(tokens);
+    if (stats)
+    {
+        stats->FoldedExpressions = folded;
+        stats->RenamedLocals = renamed;
+    }
+
+    std::string result;
+    result.reserve(source.size());
+    for (size_t i = 0; i < tokens.size(); i++)
+    {
+        const Token& token = tokens[i];
+        if (token.Type == TokenType::Directive)
+        {
+            if (!result.empty() && result.back() != '\n')
+                result += '\n';
+            result += token.Text;
+            result += '\n';
+            continue;
+        }
+        if (i > 0 && tokens[i - 1].Type != TokenType::Directive && NeedsSpace(tokens[i - 1], token))
+            result += ' ';
+        result += token.Text;
+    }
+    if (!result.empty() && result.back() != '\n')
+        result += '\n';
+    return result;
+}
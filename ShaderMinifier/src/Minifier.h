@@ -0,0 +1,22 @@
+#pragma once
+#include <string>
+#include <string_view>
+
+//What MinifyGLSL() did to one stage
+struct MinifyStats
+{
+    unsigned int FoldedExpressions = 0;
+    unsigned int RenamedLocals = 0;
+};
+
+//Shrinks one GLSL stage without changing what it computes:
+//  - comments and whitespace go, a space is only kept where two tokens would
+//    otherwise run together, and every preprocessor line stays on its own line
+//  - a binary + - * / between two plain literals of the same type is folded,
+//    when precedence makes that the whole operation (1.0 * 0.5 + x -> .5+x),
+//    and float literals are written in their shortest exact form (0.50 -> .5)
+//  - a function's parameters and local variables get the shortest free names,
+//    unless the name is used anywhere outside that function or in a #directive,
+//    so uniforms, ins/outs, struct members and functions keep their names
+//Anything it doesn't understand is copied as is.
+std::string MinifyGLSL(std::string_view source, MinifyStats* stats = nullptr);
@@ -0,0 +1,171 @@
+//Writes a smaller copy of .shader files, checked against the driver.
+//
+//  ShaderMinifier [--no-validate] [--runs N] [-o output.shader] <input.shader>...
+//
+//Every #shader stage is #include expanded and run through MinifyGLSL(). Both
+//versions of each stage are then compiled on a headless context, the best of
+//N runs each, and the sizes and compile times are printed side by side. A
+//stage that compiled before and doesn't after stops the tool without writing
+//anything. The output goes next to the input as <name>.min.shader unless -o
+//is given (one input only).
+#include "Headless.h"
+#include "Minifier.h"
+#include "ShaderParser.h"
+#include "ShaderPreprocessor.h"
+
+#include <GL/glew.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+//Compiles source and returns the time the compile took in ms, or -1 with the
+//log printed if it failed. Every run gets a different #define after #version,
+//so a driver's shader cache can't answer from an earlier run.
+static double TimeCompile(unsigned int type, std::string_view source, int run, bool printLog)
+{
+    size_t version = source.find("#version");
+    size_t insertAt = version == std::string_view::npos ? 0 : source.find('\n', version) + 1;
+    std::string text(source.substr(0, insertAt));
+    text += "#define SHADER_MINIFIER_RUN " + std::to_string(run) + "\n";
+    text.append(source.substr(insertAt));
+
+    auto start = std::chrono::steady_clock::now();
+    unsigned int shader = glCreateShader(type);
+    const char* data = text.data();
+    int length = (int)text.size();
+    glShaderSource(shader, 1, &data, &length);
+    glCompileShader(shader);
+    //asking for the status waits for the compile, even with parallel compile on
+    int compiled = GL_FALSE;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &compiled);
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+    if (!compiled && printLog)
+    {
+        int logLength = 0;
+        glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &logLength);
+        std::string log(std::max(logLength, 1), '\0');
+        glGetShaderInfoLog(shader, logLength, &logLength, &log[0]);
+        std::cout << log << std::endl;
+    }
+    glDeleteShader(shader);
+    return compiled ? elapsed.count() : -1.0;
+}
+
+static double BestCompile(unsigned int type, std::string_view source, int runs, int& runId)
+{
+    double best = -1.0;
+    for (int i = 0; i < runs; i++)
+    {
+        double ms = TimeCompile(type, source, runId++, i == 0);
+        if (ms < 0.0)
+            return -1.0;
+        if (best < 0.0 || ms < best)
+            best = ms;
+    }
+    return best;
+}
+
+static std::string OutputPath(const std::string& input)
+{
+    size_t dot = input.rfind(".shader");
+    return (dot == std::string::npos ? input : input.substr(0, dot)) + ".min.shader";
+}
+
+int main(int argc, char** argv)
+{
+    bool validate = true;
+    int runs = 5;
+    std::string output;
+    std::vector<std::string> inputs;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--no-validate") == 0)
+            validate = false;
+        else if (strcmp(argv[i], "--runs") == 0 && i + 1 < argc)
+            runs = std::max(1, atoi(argv[++i]));
+        else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc)
+            output = argv[++i];
+        else
+            inputs.push_back(argv[i]);
+    }
+    if (inputs.empty() || (!output.empty() && inputs.size() > 1))
+    {
+        std::cout << "usage: ShaderMinifier [--no-validate] [--runs N] [-o output.shader] <input.shader>..." << std::endl;
+        return 1;
+    }
+
+    HeadlessContext context;
+    if (validate)
+    {
+        if (!context.Create())
+        {
+            std::cout << "No GL context to validate with, rerun with --no-validate to skip it" << std::endl;
+            return 1;
+        }
+        glewExperimental = GL_TRUE;
+        GLenum glewStatus = glewInit();
+        if (glewStatus != GLEW_OK && glewStatus != GLEW_ERROR_NO_GLX_DISPLAY)
+        {
+            std::cout << "glewInit failed: " << glewGetErrorString(glewStatus) << std::endl;
+            return 1;
+        }
+        std::cout << "Validating on " << glGetString(GL_RENDERER) << ", best of " << runs << " compiles" << std::endl;
+    }
+
+    int runId = 0;
+    for (const std::string& input : inputs)
+    {
+        const std::string& text = ShaderPreprocessor::Get().Expand(input);
+        if (text.empty())
+            return 1;
+
+        std::string minified;
+        std::cout << input << std::endl;
+        printf("  %-10s %8s %8s %7s %9s %9s %7s\n", "stage", "bytes", "min", "", "ms", "min ms", "");
+        for (const ShaderStageView& stage : ParseShaderStages(text))
+        {
+            MinifyStats stats;
+            std::string small = MinifyGLSL(stage.Source, &stats);
+            minified += "#shader " + std::string(stage.Name) + "\n" + small;
+
+            printf("  %-10.*s %8zu %8zu %6.1f%%", (int)stage.Name.size(), stage.Name.data(),
+                stage.Source.size(), small.size(), 100.0 * small.size() / std::max<size_t>(stage.Source.size(), 1));
+            if (validate && stage.Type != 0)
+            {
+                double before = BestCompile(stage.Type, stage.Source, runs, runId);
+                double after = BestCompile(stage.Type, small, runs, runId);
+                if (before >= 0.0 && after < 0.0)
+                {
+                    printf("\n");
+                    std::cout << "  the minified " << stage.Name << " stage doesn't compile, nothing written" << std::endl;
+                    return 1;
+                }
+                if (before < 0.0)
+                    printf(" %9s %9s", "failed", "-");
+                else
+                    printf(" %9.3f %9.3f %6.1f%%", before, after, 100.0 * after / std::max(before, 1e-6));
+            }
+            printf("  (%u folded, %u renamed)\n", stats.FoldedExpressions, stats.RenamedLocals);
+        }
+
+        std::string path = output.empty() ? OutputPath(input) : output;
+        std::ofstream stream(path, std::ios::binary);
+        stream << minified;
+        if (!stream)
+        {
+            std::cout << "Failed to write " << path << std::endl;
+            return 1;
+        }
+        std::cout << "  wrote " << path << std::endl;
+    }
+
+    if (validate)
+        context.Destroy();
+    return 0;
+}
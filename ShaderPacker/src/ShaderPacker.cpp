@@ -0,0 +1,252 @@
+//Packs .shader files into one archive the app can mmap at startup.
+//
+//  ShaderPacker <output.pack> <file or directory>...
+//  ShaderPacker --header <output.h> <file or directory>...
+//
+//Run from the directory the app runs in (OpenGL/), so the names stored in
+//the archive are the same paths the app asks for, e.g.
+//  ShaderPacker res/shaders.pack res/shaders
+//Directories are searched (not recursively) for *.shader files. #includes are
+//expanded and the stages split here, the archive only holds finished sources.
+//
+//--header writes a C++ header instead, with every file as a string literal
+//and SplitShaderSections() run on it at compile time, for EMBEDDED_SHADERS builds:
+//  ShaderPacker --header src/EmbeddedShaders.generated.h res/shaders
+#include "ShaderArchive.h"
+#include "ShaderParser.h"
+#include "ShaderPreprocessor.h"
+#include "ShaderReflection.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+struct PackedProgram
+{
+    std::string Name;
+    std::string Text; //the expanded file, the stages point into it
+    std::vector<ShaderStageView> Stages;
+};
+
+static void CollectInputs(const std::string& input, std::vector<std::string>& files)
+{
+    std::error_code error;
+    if (!std::filesystem::is_directory(input, error))
+    {
+        files.push_back(input);
+        return;
+    }
+    std::vector<std::string> found;
+    for (const auto& item : std::filesystem::directory_iterator(input, error))
+    {
+        if (item.is_regular_file() && item.path().extension() == ".shader")
+            found.push_back(item.path().generic_string());
+    }
+    //directory order isn't stable, the archive should be
+    std::sort(found.begin(), found.end());
+    files.insert(files.end(), found.begin(), found.end());
+}
+
+//"res/shaders/Basic.shader" -> "res_shaders_Basic_shader"
+static std::string Identifier(const std::string& name)
+{
+    std::string identifier;
+    for (char c : name)
+        identifier += isalnum((unsigned char)c) ? c : '_';
+    if (identifier.empty() || isdigit((unsigned char)identifier[0]))
+        identifier.insert(identifier.begin(), '_');
+    return identifier;
+}
+
+//text as adjacent raw string literals. MSVC caps a single literal at about 16KB,
+//so long files are cut into pieces at line ends (or anywhere, for a very long line)
+static std::string RawLiterals(const std::string& text)
+{
+    std::string delimiter = "GLSL";
+    while (text.find(")" + delimiter + "\"") != std::string::npos)
+        delimiter += "_";
+
+    const size_t maxPiece = 8 * 1024;
+    std::string literals;
+    for (size_t start = 0; start < text.size() || start == 0;)
+    {
+        size_t end = std::min(text.size(), start + maxPiece);
+        if (end < text.size())
+        {
+            size_t lineEnd = text.rfind('\n', end - 1);
+            if (lineEnd != std::string::npos && lineEnd >= start)
+                end = lineEnd + 1;
+        }
+        literals += "    R\"" + delimiter + "(" + text.substr(start, end - start) + ")" + delimiter + "\"\n";
+        if (end == start)
+            break;
+        start = end;
+    }
+    return literals;
+}
+
+static bool WriteHeader(const std::string& path, const std::vector<PackedProgram>& programs)
+{
+    std::string header =
+        "//Generated by ShaderPacker --header, don't edit. Rebuild it after changing a shader.\n"
+        "#pragma once\n"
+        "#include \"ShaderParser.h\"\n"
+        "#include <string_view>\n\n"
+        "namespace EmbeddedShaderText\n{\n";
+    for (const PackedProgram& program : programs)
+    {
+        header += "    //" + program.Name + "\n";
+        header += "    inline constexpr std::string_view " + Identifier(program.Name) + " =\n" + RawLiterals(program.Text) + "    ;\n";
+    }
+    header +=
+        "}\n\n"
+        "struct EmbeddedShader\n{\n"
+        "    std::string_view Name;\n"
+        "    EmbeddedShaderSource Source;\n"
+        "};\n\n"
+        "//split at compile time, the stages are views into the literals above\n"
+        "inline constexpr EmbeddedShader s_EmbeddedShaders[] =\n{\n";
+    for (const PackedProgram& program : programs)
+    {
+        header += "    { \"" + program.Name + "\", SplitShaderSections(EmbeddedShaderText::" + Identifier(program.Name) + ") },\n";
+    }
+    header +=
+        "};\n\n"
+        "//the embedded shader packed from name (\"./\" prefix optional), empty stages if there isn't one\n"
+        "constexpr EmbeddedShaderSource FindEmbeddedShader(std::string_view name)\n{\n"
+        "    while (name.substr(0, 2) == \"./\")\n"
+        "        name.remove_prefix(2);\n"
+        "    for (const EmbeddedShader& shader : s_EmbeddedShaders)\n"
+        "    {\n"
+        "        if (shader.Name == name)\n"
+        "            return shader.Source;\n"
+        "    }\n"
+        "    return {};\n"
+        "}\n";
+
+    std::ofstream stream(path, std::ios::binary);
+    stream << header;
+    if (!stream)
+    {
+        std::cout << "Failed to write " << path << std::endl;
+        return false;
+    }
+    std::cout << "Embedded " << programs.size() << " programs into " << path << std::endl;
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    bool writeHeader = argc > 1 && strcmp(argv[1], "--header") == 0;
+    int firstArg = writeHeader ? 2 : 1;
+    if (argc < firstArg + 2)
+    {
+        std::cout << "usage: ShaderPacker [--header] <output> <file or directory>..." << std::endl;
+        return 1;
+    }
+    const char* outputPath = argv[firstArg];
+
+    std::vector<std::string> files;
+    for (int i = firstArg + 1; i < argc; i++)
+        CollectInputs(argv[i], files);
+
+    if (files.empty())
+    {
+        std::cout << "No .shader files to pack" << std::endl;
+        return 1;
+    }
+
+    std::vector<PackedProgram> programs;
+    for (const std::string& file : files)
+    {
+        PackedProgram program;
+        program.Name = std::filesystem::path(file).lexically_normal().generic_string();
+        program.Text = ShaderPreprocessor::Get().Expand(file);
+        if (program.Text.empty())
+            return 1;
+        program.Stages = ParseShaderStages(program.Text);
+        for (const ShaderStageView& stage : program.Stages)
+        {
+            if (stage.Type == 0)
+            {
+                std::cout << file << ": unknown shader type \"" << stage.Name << "\"" << std::endl;
+                return 1;
+            }
+        }
+        programs.push_back(std::move(program));
+    }
+    if (writeHeader)
+        return WriteHeader(outputPath, programs) ? 0 : 1;
+
+    std::sort(programs.begin(), programs.end(), [](const PackedProgram& a, const PackedProgram& b)
+        {
+            return HashName(a.Name) < HashName(b.Name);
+        });
+
+    ShaderArchiveHeader header = { { 'G', 'L', 'S', 'A' }, s_ShaderArchiveVersion, (uint32_t)programs.size(), 0 };
+    for (const PackedProgram& program : programs)
+        header.StageCount += (uint32_t)program.Stages.size();
+
+    //lay out the tables first, the strings go after them
+    std::vector<ShaderArchiveEntry> entries;
+    std::vector<ShaderArchiveStage> stages;
+    std::string strings;
+    size_t stringsStart = sizeof(header) + programs.size() * sizeof(ShaderArchiveEntry)
+        + header.StageCount * sizeof(ShaderArchiveStage);
+    auto addString = [&](std::string_view text)
+    {
+        uint32_t offset = (uint32_t)(stringsStart + strings.size());
+        strings.append(text);
+        strings += '\0';
+        return offset;
+    };
+
+    for (const PackedProgram& program : programs)
+    {
+        ShaderArchiveEntry entry;
+        entry.NameHash = HashName(program.Name);
+        entry.NameLength = (uint32_t)program.Name.size();
+        entry.NameOffset = addString(program.Name);
+        entry.FirstStage = (uint32_t)stages.size();
+        entry.StageCount = (uint32_t)program.Stages.size();
+        entries.push_back(entry);
+        for (const ShaderStageView& view : program.Stages)
+        {
+            ShaderArchiveStage stage = {};
+            stage.Type = view.Type;
+            stage.SourceLength = (uint32_t)view.Source.size();
+            stage.SourceOffset = addString(view.Source);
+            stages.push_back(stage);
+        }
+    }
+
+    std::string tempPath = std::string(outputPath) + ".tmp";
+    {
+        std::ofstream stream(tempPath, std::ios::binary);
+        stream.write((const char*)&header, sizeof(header));
+        stream.write((const char*)entries.data(), entries.size() * sizeof(ShaderArchiveEntry));
+        stream.write((const char*)stages.data(), stages.size() * sizeof(ShaderArchiveStage));
+        stream.write(strings.data(), strings.size());
+        if (!stream)
+        {
+            std::cout << "Failed to write " << tempPath << std::endl;
+            return 1;
+        }
+    }
+    std::error_code error;
+    std::filesystem::rename(tempPath, outputPath, error);
+    if (error)
+    {
+        std::cout << "Failed to write " << outputPath << ": " << error.message() << std::endl;
+        return 1;
+    }
+
+    std::cout << "Packed " << programs.size() << " programs (" << header.StageCount << " stages) into "
+        << outputPath << std::endl;
+    return 0;
+}